@@ -0,0 +1,71 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <cstddef>
+
+// Limits how many frames CPU runs ahead of GPU. Every frame ends with a fence,
+// begin_frame() waits for the fence of the frame submitted frames() ago, so
+// per-frame resources indexed by index() (ring buffer regions, staging buffers,
+// query pools) are no longer read by GPU and can be rewritten without sync.
+// 1 frame in flight gives lowest latency, 3 keep GPU busiest.
+//
+// Per frame : begin_frame(), record commands, end_frame() before swap
+class FrameSync {
+public:
+    static const unsigned int max_frames = 3;
+private:
+    unsigned int frames_count;
+    unsigned int frame_index;
+    GLsync       fences[max_frames];
+
+    // Fence wait statistics
+    size_t       frames_total;
+    size_t       stalled_frames;    // Fence was not signaled at begin_frame()
+    double       last_wait;
+    double       total_wait;
+    double       max_wait;
+public:
+    explicit FrameSync(unsigned int frames = 2);
+    FrameSync(const FrameSync& rhs) = delete;
+    FrameSync& operator= (const FrameSync& rhs) = delete;
+    ~FrameSync();
+
+    // Waits until GPU has finished with resources of index() slot
+    void begin_frame();
+
+    // Fences commands submitted this frame
+    void end_frame();
+
+    // Blocks until all frames in flight are complete (before readback or shutdown)
+    void wait_idle();
+
+    unsigned int frames() const {
+        return frames_count;
+    }
+
+    // Slot of current frame, 0 .. frames() - 1
+    unsigned int index() const {
+        return frame_index;
+    }
+
+    // Seconds spent in fence waits
+    double wait_time() const {
+        return last_wait;
+    }
+
+    double average_wait() const {
+        return frames_total ? total_wait / frames_total : 0.0;
+    }
+
+    double longest_wait() const {
+        return max_wait;
+    }
+
+    size_t frames_stalled() const {
+        return stalled_frames;
+    }
+
+    size_t frames_submitted() const {
+        return frames_total;
+    }
+};
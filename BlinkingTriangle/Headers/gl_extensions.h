@@ -0,0 +1,36 @@
+#pragma once
+
+#include <glad/gl.h>
+
+// Generated glad loader covers GL 3.3 only, newer entry points are loaded here
+// the same way and must be checked for availability before use
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+#ifndef GL_DYNAMIC_STORAGE_BIT
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#endif
+
+typedef void (GLAD_API_PTR *PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+extern PFNGLBUFFERSTORAGEPROC glad_glBufferStorage;
+#define glBufferStorage glad_glBufferStorage
+
+struct GLExtensions {
+    GLint major_version;
+    GLint minor_version;
+    bool  buffer_storage;       // GL 4.4 or GL_ARB_buffer_storage
+};
+
+extern GLExtensions gl_extensions;
+
+// Must be called after gladLoadGL with current context
+void load_gl_extensions(GLADloadfunc load);
+
+bool has_gl_extension(const char* name);
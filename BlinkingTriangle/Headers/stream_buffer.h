@@ -0,0 +1,47 @@
+#pragma once
+
+#include <frame_sync.h>
+
+// Ring buffer for data rewritten every frame (dynamic vertices, uniforms).
+// Buffer is split into one region per frame in flight, CPU writes region of
+// current FrameSync slot while GPU still reads previous ones. FrameSync fences
+// guarantee region is free, so no implicit driver synchronization is needed.
+// With GL 4.4 storage is mapped once persistently and coherently, so writes are
+// plain memcpy. Older contexts map current region unsynchronized every frame.
+//
+// Per frame : sync.begin_frame(), begin_frame(), allocate() blocks, flush(), draw
+class StreamBuffer {
+    const FrameSync& sync;
+
+    GLenum     target;
+    GLuint     buffer_id;
+    GLsizeiptr frame_size;
+    bool       persistent;
+
+    GLubyte*   mapped;          // Whole buffer when persistent, current region otherwise
+    GLsizeiptr frame_offset;    // Current region start in buffer
+    GLsizeiptr used;            // Bytes allocated in current region
+public:
+    StreamBuffer(GLenum buffer_target, GLsizeiptr region_size, const FrameSync& frame_sync);
+    StreamBuffer(const StreamBuffer& rhs) = delete;
+    StreamBuffer& operator= (const StreamBuffer& rhs) = delete;
+    ~StreamBuffer();
+
+    GLuint id() const {
+        return buffer_id;
+    }
+
+    bool is_persistent() const {
+        return persistent;
+    }
+
+    // Switches to region of current frame slot
+    void begin_frame();
+
+    // Returns write pointer for size bytes or NULL when region is full,
+    // offset receives position in buffer for draw calls and binding
+    void* allocate(GLsizeiptr size, GLsizeiptr alignment, GLintptr* offset);
+
+    // Writes must be visible to GL before draws use them
+    void flush();
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stream_buffer.h>
+#include <cstddef>    // offsetof
+
+// Binding points of uniform blocks, same for every shader program
+enum UniformBlockBinding {
+    FRAME_BLOCK_BINDING = 0,
+    DRAW_BLOCK_BINDING  = 1
+};
+
+// C++ mirrors of std140 uniform blocks. Offsets follow std140 rules :
+// scalars are 4 bytes aligned, vec4 - 16 bytes, block size rounds up to 16 bytes.
+
+// layout (std140) uniform FrameBlock
+struct FrameUniforms {
+    GLfloat time;           // float time
+    GLfloat padding[3];
+};
+
+static_assert(offsetof(FrameUniforms, time) == 0, "FrameBlock.time offset mismatch");
+static_assert(sizeof(FrameUniforms) == 16, "FrameBlock size mismatch");
+
+// layout (std140) uniform DrawBlock
+struct DrawUniforms {
+    GLfloat main_color[4];  // vec4 mainColor
+    GLfloat transform[4];   // vec4 transform : X offset, Y offset, scale, unused
+};
+
+static_assert(offsetof(DrawUniforms, main_color) == 0, "DrawBlock.mainColor offset mismatch");
+static_assert(offsetof(DrawUniforms, transform) == 16, "DrawBlock.transform offset mismatch");
+static_assert(sizeof(DrawUniforms) == 32, "DrawBlock size mismatch");
+
+// Per-frame block and per-draw blocks are sub-allocated from one stream buffer,
+// so all uniforms of a frame go to GPU with single upload.
+//
+// Per frame : begin_frame(), add_draw() for every draw, flush(),
+// then bind_draw() before every draw call
+class UniformBlocks {
+    StreamBuffer stream;
+    GLint        alignment;
+    GLintptr     frame_offset;
+public:
+    UniformBlocks(GLsizeiptr frame_size, const FrameSync& sync);
+
+    // Connects program blocks to binding points, missing blocks are skipped
+    static void bind_program(GLuint program_id);
+
+    void begin_frame(const FrameUniforms& frame);
+
+    // Returns block offset for bind_draw() or -1 when frame region is full
+    GLintptr add_draw(const DrawUniforms& draw);
+
+    void flush();
+    void bind_draw(GLintptr offset) const;
+};
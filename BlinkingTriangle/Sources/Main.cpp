@@ -1,9 +1,17 @@
+#include <frame_sync.h>
+#include <stream_buffer.h>
+#include <uniform_blocks.h>
+#include <gl_extensions.h>
+#include <frame_pacing.h>
+#include <gpu_profiler.h>
+#include <gl_call_stats.h>
 #define GLAD_GL_IMPLEMENTATION
 #include <glad/gl.h>
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
 #include <iostream>
-#include <cmath>
+#include <cstring>
+#include <cstdlib>
 
 using namespace std;
 
@@ -12,6 +20,9 @@ static void error_callback(int error, const char* description)
     fprintf(stderr, "Error: %s\n", description);
 }
 
+// Paused triangle does not blink, on-demand mode stops redrawing
+static bool animation_paused = false;
+
 static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
     static bool wireframe = true;
@@ -26,6 +37,9 @@ static void key_callback(GLFWwindow* window, int key, int scancode, int action,
                 glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
             wireframe = !wireframe;
             break;
+        case GLFW_KEY_P:
+            animation_paused = !animation_paused;
+            break;
         }
     }
 }
@@ -33,19 +47,32 @@ static void key_callback(GLFWwindow* window, int key, int scancode, int action,
 static const char* vertex_shader_text = 
 "#version 330 core\n"
 "layout (location = 0) in vec3 position;\n"
+"layout (std140) uniform DrawBlock\n"
+"{\n"
+"    vec4 mainColor;\n"
+"    vec4 transform;\n"
+"};\n"
 "out vec3 vertexColor;\n"
 "void main()\n"
 "{\n"
-"    gl_Position = vec4(position.x, position.y, position.z, 1.0);\n"
+"    gl_Position = vec4(position.xy * transform.z + transform.xy, position.z, 1.0);\n"
 "}";
 
 static const char* fragment_shader_text = 
 "#version 330 core\n"
 "out vec4 color;\n"
-"uniform vec4 mainColor;\n"
+"layout (std140) uniform FrameBlock\n"
+"{\n"
+"    float time;\n"
+"};\n"
+"layout (std140) uniform DrawBlock\n"
+"{\n"
+"    vec4 mainColor;\n"
+"    vec4 transform;\n"
+"};\n"
 "void main()\n"
 "{\n"
-"    color = mainColor;\n"
+"    color = vec4(mainColor.rgb * (sin(2.0 * time) + 0.2), mainColor.a);\n"
 "}\n";
 
 GLfloat vertices[] = {
@@ -58,6 +85,26 @@ GLfloat vertices[] = {
 int main(int argc, char** argv)
 {
     cout << "Application started..." << endl;
+
+    // Frame pacing : --vsync off|on|adaptive, --fps N, --on-demand, --pacing-report
+    // Frames CPU may run ahead of GPU : --frames 1..3
+    // GPU scope timings : --gpu-profile
+    // GL call statistics (debug builds) : --gl-calls
+    FramePacingConfig pacing = default_frame_pacing();
+    unsigned int frames_in_flight = 2;
+    bool gpu_profile = false;
+    bool gl_calls = false;
+    for(int i = 1; i < argc; ++i) {
+        if(parse_frame_pacing_arg(i, argc, argv, pacing))
+            continue;
+        if(strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            frames_in_flight = (unsigned int)atoi(argv[++i]);
+        else if(strcmp(argv[i], "--gpu-profile") == 0)
+            gpu_profile = true;
+        else if(strcmp(argv[i], "--gl-calls") == 0)
+            gl_calls = true;
+    }
+
     if (!glfwInit())
         exit(EXIT_FAILURE);
 
@@ -82,18 +129,24 @@ int main(int argc, char** argv)
 
     // Initialize OpenGL
     gladLoadGL(glfwGetProcAddress);
+    load_gl_extensions(glfwGetProcAddress);
+
+    if(gl_calls && !install_gl_call_stats())
+        cerr << "Error : GL call statistics are compiled in debug builds only" << endl;
+    cout << "OpenGL version : " << gl_extensions.major_version << "." << gl_extensions.minor_version << endl;
 
     int width, height;
     glfwGetFramebufferSize(window, &width, &height);
     glViewport(0, 0, width, height);
 
 
-    // Create buffers
-    GLuint vao_id, vbo_id;
+    // Create buffers, vertices are rewritten every frame through stream buffer
+    FrameSync frame_sync(frames_in_flight);
+    cout << "Frames in flight : " << frame_sync.frames() << endl;
+    GLuint vao_id;
     glGenVertexArrays(1, &vao_id);
-    glGenBuffers(1, &vbo_id);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    StreamBuffer vertex_stream(GL_ARRAY_BUFFER, 64 * 1024, frame_sync);
+    cout << "Stream buffer : " << (vertex_stream.is_persistent() ? "persistent mapping" : "unsynchronized mapping") << endl;
 
     // Create shader program
     const unsigned int max_log_length = 512;
@@ -144,7 +197,8 @@ int main(int argc, char** argv)
 
     cout << "Shader program created" << endl;
 
-    GLint mainColorLocation = glGetUniformLocation(shader_program_id, "mainColor");
+    UniformBlocks::bind_program(shader_program_id);
+    UniformBlocks uniforms(16 * 1024, frame_sync);
 
     glUseProgram(shader_program_id);
     glDeleteShader(vertex_shader_id);
@@ -162,35 +216,85 @@ int main(int argc, char** argv)
     //     step
     glBindVertexArray(vao_id);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(
-        0,                          // Input layout position in vertex shader
-        3,                          // Input vector size
-        GL_FLOAT,                   // Data type
-        GL_FALSE,                   // No need to normalize data
-        3 * sizeof(GL_FLOAT),       // Data step
-        (GLvoid*)0                  // Start data offset
-    );
 
     glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
 
 
     // Main loop
+    FramePacer pacer(pacing);
+    GpuProfiler gpu_profiler(gpu_profile);
+    double profile_report_time = glfwGetTime();
+    double animation_time = 0.0, last_time = glfwGetTime();
     while (!glfwWindowShouldClose(window))
     {
-        glfwPollEvents();
-
-        // Update main color
-        GLfloat timeValue = glfwGetTime();
-        GLfloat greenValue = sin(2.0f * timeValue) + 0.2f;
-        glUniform4f(mainColorLocation, 0.0f, greenValue, 0.0f, 1.0f);
+        pacer.wait_events(!animation_paused);
+
+        // Update uniforms, main color blinks in shader using animation time
+        const double now = glfwGetTime();
+        if(!animation_paused)
+            animation_time += now - last_time;
+        last_time = now;
+        FrameUniforms frame_uniforms = {};
+        frame_uniforms.time = animation_time;
+        frame_sync.begin_frame();
+        uniforms.begin_frame(frame_uniforms);
+
+        const DrawUniforms triangle_uniforms = {
+            { 0.0f, 1.0f, 0.0f, 1.0f },     // Main color
+            { 0.0f, 0.0f, 1.0f, 0.0f }      // No offset, original scale
+        };
+        GLintptr triangle_uniforms_offset = uniforms.add_draw(triangle_uniforms);
+        uniforms.flush();
+
+        // Write vertices of current frame, data offset changes every frame
+        vertex_stream.begin_frame();
+        GLintptr vertices_offset = 0;
+        void* vertices_data = vertex_stream.allocate(sizeof(vertices), sizeof(GLfloat), &vertices_offset);
+        if(vertices_data)
+            memcpy(vertices_data, vertices, sizeof(vertices));
+        vertex_stream.flush();
+
+        glBindBuffer(GL_ARRAY_BUFFER, vertex_stream.id());
+        glVertexAttribPointer(
+            0,                          // Input layout position in vertex shader
+            3,                          // Input vector size
+            GL_FLOAT,                   // Data type
+            GL_FALSE,                   // No need to normalize data
+            3 * sizeof(GL_FLOAT),       // Data step
+            (GLvoid*)vertices_offset    // Start data offset
+        );
 
         // Render
-        glClear(GL_COLOR_BUFFER_BIT);
-        glDrawArrays(GL_TRIANGLES, 0, 3);
+        gpu_profiler.begin_frame();
+        {
+            GpuScope frame_scope(gpu_profiler, "frame");
+            {
+                GpuScope clear_scope(gpu_profiler, "clear");
+                glClear(GL_COLOR_BUFFER_BIT);
+            }
+            GpuScope draw_scope(gpu_profiler, "triangle");
+            uniforms.bind_draw(triangle_uniforms_offset);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+        }
+        gpu_profiler.end_frame();
+        frame_sync.end_frame();
+        gl_call_stats_end_frame();
 
         glfwSwapBuffers(window);
+        pacer.end_frame();
+
+        if(gpu_profiler.is_enabled() && glfwGetTime() - profile_report_time >= 2.0) {
+            gpu_profiler.print(cout);
+            profile_report_time = glfwGetTime();
+        }
     }
 
+    // Time CPU was blocked by GPU, high values mean more frames in flight would help
+    frame_sync.wait_idle();
+    cout << "Fence waits : " << frame_sync.frames_stalled() << " of " << frame_sync.frames_submitted()
+         << " frames, average " << frame_sync.average_wait() * 1000.0
+         << " ms, longest " << frame_sync.longest_wait() * 1000.0 << " ms" << endl;
+
     // Shutdown
     glfwDestroyWindow(window);
     glfwTerminate();
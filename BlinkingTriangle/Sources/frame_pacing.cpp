@@ -0,0 +1,119 @@
+#include <frame_pacing.h>
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <thread>
+
+// Sleep may wake up this late, rest of frame time is spun
+static const std::chrono::microseconds spin_time(1500);
+
+// Interval between reports
+static const double report_period = 5.0;
+
+static const char* swap_mode_names[] = { "default", "off", "on", "adaptive" };
+
+// Process CPU time of all threads
+static double cpu_seconds() {
+    return (double)std::clock() / CLOCKS_PER_SEC;
+}
+
+FramePacingConfig default_frame_pacing() {
+    return { SWAP_DEFAULT, 0.0, false, false };
+}
+
+bool parse_frame_pacing_arg(int& i, int argc, char** argv, FramePacingConfig& config) {
+    if(strcmp(argv[i], "--vsync") == 0 && i + 1 < argc) {
+        ++i;
+        if(strcmp(argv[i], "off") == 0)
+            config.swap_mode = SWAP_OFF;
+        else if(strcmp(argv[i], "on") == 0)
+            config.swap_mode = SWAP_VSYNC;
+        else if(strcmp(argv[i], "adaptive") == 0)
+            config.swap_mode = SWAP_ADAPTIVE;
+        else
+            std::cerr << "Error : unknown vsync mode " << argv[i] << ", expected off, on or adaptive" << std::endl;
+        return true;
+    }
+    if(strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+        config.max_fps = atof(argv[++i]);
+        return true;
+    }
+    if(strcmp(argv[i], "--on-demand") == 0) {
+        config.on_demand = true;
+        return true;
+    }
+    if(strcmp(argv[i], "--pacing-report") == 0) {
+        config.report = true;
+        return true;
+    }
+    return false;
+}
+
+FramePacer::FramePacer(const FramePacingConfig& config)
+    : config(config), next_frame(Clock::now()), report_start(Clock::now()),
+      report_cpu_start(cpu_seconds()), report_frames(0), first_frame(true) {
+    if(this->config.swap_mode == SWAP_ADAPTIVE &&
+       !glfwExtensionSupported("WGL_EXT_swap_control_tear") && !glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+        std::cerr << "Error : adaptive vsync is not supported, vsync is used" << std::endl;
+        this->config.swap_mode = SWAP_VSYNC;
+    }
+
+    switch(this->config.swap_mode) {
+    case SWAP_OFF:
+        glfwSwapInterval(0);
+        break;
+    case SWAP_VSYNC:
+        glfwSwapInterval(1);
+        break;
+    case SWAP_ADAPTIVE:
+        glfwSwapInterval(-1);
+        break;
+    case SWAP_DEFAULT:
+        break;
+    }
+}
+
+void FramePacer::wait_events(bool animating) {
+    if(config.on_demand && !animating && !first_frame)
+        glfwWaitEvents();
+    else
+        glfwPollEvents();
+    first_frame = false;
+}
+
+void FramePacer::end_frame() {
+    if(config.max_fps > 0.0) {
+        const Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / config.max_fps));
+        next_frame += period;
+        Clock::time_point now = Clock::now();
+        // Late frame (or wait for events) starts new schedule instead of hurrying to catch up
+        if(next_frame < now) {
+            next_frame = now;
+        } else {
+            if(next_frame - now > spin_time)
+                std::this_thread::sleep_for(next_frame - now - spin_time);
+            while(Clock::now() < next_frame)
+                std::this_thread::yield();
+        }
+    }
+
+    ++report_frames;
+    if(config.report && std::chrono::duration<double>(Clock::now() - report_start).count() >= report_period)
+        report();
+}
+
+void FramePacer::report() {
+    const double wall = std::chrono::duration<double>(Clock::now() - report_start).count();
+    const double cpu = cpu_seconds() - report_cpu_start;
+    std::cout << "Swap interval : " << swap_mode_names[config.swap_mode]
+              << ", limit : " << (config.max_fps > 0.0 ? config.max_fps : 0.0) << " FPS"
+              << (config.on_demand ? ", on demand" : "")
+              << ", FPS : " << report_frames / wall
+              << ", CPU : " << cpu / wall * 100.0 << " %" << std::endl;
+    report_start = Clock::now();
+    report_cpu_start = cpu_seconds();
+    report_frames = 0;
+}
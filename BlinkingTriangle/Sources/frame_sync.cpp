@@ -0,0 +1,71 @@
+#include <frame_sync.h>
+#include <chrono>
+#include <iostream>   // cerr
+
+typedef std::chrono::steady_clock Clock;
+
+// Returns false when fence is still pending after timeout
+static bool wait_fence(GLsync fence, GLuint64 timeout, bool flush) {
+    GLenum result = glClientWaitSync(fence, flush ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, timeout);
+    if(result == GL_WAIT_FAILED) {
+        std::cerr << "Error : frame fence wait failed" << std::endl;
+        return true;
+    }
+    return result != GL_TIMEOUT_EXPIRED;
+}
+
+FrameSync::FrameSync(unsigned int frames) :
+    frames_count(frames < 1 ? 1 : (frames > max_frames ? max_frames : frames)), frame_index(0), fences(),
+    frames_total(0), stalled_frames(0), last_wait(0.0), total_wait(0.0), max_wait(0.0) {
+}
+
+FrameSync::~FrameSync() {
+    for(unsigned int i = 0; i < frames_count; ++i)
+        if(fences[i]) glDeleteSync(fences[i]);
+}
+
+void FrameSync::begin_frame() {
+    frame_index = (frame_index + 1) % frames_count;
+    last_wait = 0.0;
+
+    GLsync& fence = fences[frame_index];
+    if(!fence)
+        return;
+
+    // Fence already passed costs single poll, no clock reads
+    if(!wait_fence(fence, 0, false)) {
+        const Clock::time_point start = Clock::now();
+        // Flush on first wait only, otherwise fence may never be submitted
+        const GLuint64 timeout = 1000000;   // 1 ms
+        bool flush = true;
+        while(!wait_fence(fence, timeout, flush))
+            flush = false;
+        last_wait = std::chrono::duration<double>(Clock::now() - start).count();
+        total_wait += last_wait;
+        if(last_wait > max_wait)
+            max_wait = last_wait;
+        ++stalled_frames;
+    }
+    glDeleteSync(fence);
+    fence = NULL;
+}
+
+void FrameSync::end_frame() {
+    GLsync& fence = fences[frame_index];
+    if(fence)
+        glDeleteSync(fence);
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ++frames_total;
+}
+
+void FrameSync::wait_idle() {
+    for(unsigned int i = 0; i < frames_count; ++i) {
+        if(!fences[i])
+            continue;
+        bool flush = true;
+        while(!wait_fence(fences[i], 1000000, flush))
+            flush = false;
+        glDeleteSync(fences[i]);
+        fences[i] = NULL;
+    }
+}
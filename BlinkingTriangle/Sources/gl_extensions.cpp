@@ -0,0 +1,32 @@
+#include <gl_extensions.h>
+#include <cstring>    // strcmp
+
+PFNGLBUFFERSTORAGEPROC glad_glBufferStorage = NULL;
+
+GLExtensions gl_extensions = {};
+
+static bool is_version_at_least(GLint major, GLint minor) {
+    return gl_extensions.major_version > major ||
+          (gl_extensions.major_version == major && gl_extensions.minor_version >= minor);
+}
+
+bool has_gl_extension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for(GLint i = 0; i < count; ++i) {
+        const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        if(extension && strcmp(extension, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+void load_gl_extensions(GLADloadfunc load) {
+    glGetIntegerv(GL_MAJOR_VERSION, &gl_extensions.major_version);
+    glGetIntegerv(GL_MINOR_VERSION, &gl_extensions.minor_version);
+
+    if(is_version_at_least(4, 4) || has_gl_extension("GL_ARB_buffer_storage")) {
+        glad_glBufferStorage = (PFNGLBUFFERSTORAGEPROC)load("glBufferStorage");
+    }
+    gl_extensions.buffer_storage = glad_glBufferStorage != NULL;
+}
@@ -0,0 +1,68 @@
+#include <stream_buffer.h>
+#include <gl_extensions.h>
+#include <iostream>   // cerr
+
+StreamBuffer::StreamBuffer(GLenum buffer_target, GLsizeiptr region_size, const FrameSync& frame_sync) :
+    sync(frame_sync), target(buffer_target), buffer_id(0), frame_size(region_size),
+    persistent(gl_extensions.buffer_storage), mapped(NULL), frame_offset(0), used(0) {
+    const GLsizeiptr buffer_size = frame_size * sync.frames();
+    glGenBuffers(1, &buffer_id);
+    glBindBuffer(target, buffer_id);
+
+    if(persistent) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(target, buffer_size, NULL, flags);
+        mapped = (GLubyte*)glMapBufferRange(target, 0, buffer_size, flags);
+        if(!mapped) {
+            std::cerr << "Error : failed to map stream buffer persistently, per-frame mapping will be used" << std::endl;
+            glDeleteBuffers(1, &buffer_id);
+            glGenBuffers(1, &buffer_id);
+            glBindBuffer(target, buffer_id);
+            persistent = false;
+        }
+    }
+
+    if(!persistent)
+        glBufferData(target, buffer_size, NULL, GL_STREAM_DRAW);
+}
+
+StreamBuffer::~StreamBuffer() {
+    glBindBuffer(target, buffer_id);
+    if(mapped) glUnmapBuffer(target);
+    glDeleteBuffers(1, &buffer_id);
+}
+
+void StreamBuffer::begin_frame() {
+    used = 0;
+    frame_offset = frame_size * sync.index();
+    if(persistent)
+        return;
+
+    // Region is fenced by FrameSync, driver must not wait for it
+    glBindBuffer(target, buffer_id);
+    mapped = (GLubyte*)glMapBufferRange(target, frame_offset, frame_size,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+}
+
+void* StreamBuffer::allocate(GLsizeiptr size, GLsizeiptr alignment, GLintptr* offset) {
+    if(!mapped)
+        return NULL;
+
+    GLsizeiptr start = alignment > 1 ? (used + alignment - 1) / alignment * alignment : used;
+    if(start + size > frame_size)
+        return NULL;
+
+    used = start + size;
+    *offset = frame_offset + start;
+    return persistent ? mapped + frame_offset + start : mapped + start;
+}
+
+void StreamBuffer::flush() {
+    // Coherent mapping needs nothing, writes are seen by subsequent commands
+    if(persistent || !mapped)
+        return;
+
+    glBindBuffer(target, buffer_id);
+    glUnmapBuffer(target);
+    mapped = NULL;
+}
@@ -0,0 +1,49 @@
+#include <uniform_blocks.h>
+#include <cstring>    // memcpy
+#include <iostream>   // cerr
+
+UniformBlocks::UniformBlocks(GLsizeiptr frame_size, const FrameSync& sync) :
+    stream(GL_UNIFORM_BUFFER, frame_size, sync), alignment(256), frame_offset(-1) {
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+}
+
+void UniformBlocks::bind_program(GLuint program_id) {
+    GLuint frame_block = glGetUniformBlockIndex(program_id, "FrameBlock");
+    if(frame_block != GL_INVALID_INDEX)
+        glUniformBlockBinding(program_id, frame_block, FRAME_BLOCK_BINDING);
+
+    GLuint draw_block = glGetUniformBlockIndex(program_id, "DrawBlock");
+    if(draw_block != GL_INVALID_INDEX)
+        glUniformBlockBinding(program_id, draw_block, DRAW_BLOCK_BINDING);
+}
+
+void UniformBlocks::begin_frame(const FrameUniforms& frame) {
+    stream.begin_frame();
+    void* data = stream.allocate(sizeof(FrameUniforms), alignment, &frame_offset);
+    if(data) {
+        memcpy(data, &frame, sizeof(FrameUniforms));
+    } else {
+        std::cerr << "Error : failed to allocate frame uniform block" << std::endl;
+        frame_offset = -1;
+    }
+}
+
+GLintptr UniformBlocks::add_draw(const DrawUniforms& draw) {
+    GLintptr offset = -1;
+    void* data = stream.allocate(sizeof(DrawUniforms), alignment, &offset);
+    if(!data)
+        return -1;
+    memcpy(data, &draw, sizeof(DrawUniforms));
+    return offset;
+}
+
+void UniformBlocks::flush() {
+    stream.flush();
+    if(frame_offset >= 0)
+        glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_BLOCK_BINDING, stream.id(), frame_offset, sizeof(FrameUniforms));
+}
+
+void UniformBlocks::bind_draw(GLintptr offset) const {
+    if(offset >= 0)
+        glBindBufferRange(GL_UNIFORM_BUFFER, DRAW_BLOCK_BINDING, stream.id(), offset, sizeof(DrawUniforms));
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+
+// Heap allocation counters fed by replaced global operator new / delete.
+// Hook is compiled in only with TRACK_ALLOCATIONS (cmake -DTRACK_ALLOCATIONS=ON),
+// otherwise counters stay zero. Allocations by C libraries and GL driver
+// (malloc) are not seen.
+
+struct AllocationStats {
+    size_t allocations;
+    size_t frees;
+    size_t bytes;           // Requested by allocations
+};
+
+// Hook is compiled in
+bool allocation_tracking();
+
+// Totals of all threads since start
+AllocationStats allocation_stats();
+
+// Allocations between two snapshots
+AllocationStats allocation_delta(const AllocationStats& begin, const AllocationStats& end);
+
+// Records call stack of every allocation, slow : for finding sites only
+void capture_allocation_sites(bool enable);
+
+// Sites with most allocations and their call stacks, named scopes totals
+void print_allocation_report(std::ostream& out, size_t top_sites);
+
+// Counts allocations made during its lifetime under name (string literal),
+// totals are printed by print_allocation_report()
+class AllocationScope {
+    const char*     name;
+    AllocationStats start;
+public:
+    explicit AllocationScope(const char* scope_name) : name(scope_name), start(allocation_stats()) {
+    }
+    AllocationScope(const AllocationScope& rhs) = delete;
+    AllocationScope& operator= (const AllocationScope& rhs) = delete;
+    ~AllocationScope();
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+// GL call interception for debug builds (_DEBUG). Loaded glad function pointers
+// are replaced with wrappers which count every entry point per frame, time
+// expensive calls (uploads, compiles, syncs, draws), flag state sets repeating
+// current value and glGet* / glGetError round trips. Release builds compile it
+// out : calls go straight to driver and functions below do nothing.
+
+#ifdef _DEBUG
+
+// Call after gladLoadGL(), returns false when layer is compiled out
+bool install_gl_call_stats();
+
+// Call once per frame before swap, prints per frame averages every few seconds
+void gl_call_stats_end_frame();
+
+#else
+
+inline bool install_gl_call_stats() {
+    return false;
+}
+
+inline void gl_call_stats_end_frame() {
+}
+
+#endif
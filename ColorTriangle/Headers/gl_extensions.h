@@ -0,0 +1,28 @@
+#pragma once
+
+#include <glad/gl.h>
+
+// Generated glad loader covers GL 3.3 only, newer entry points are loaded here
+// the same way and must be checked for availability before use
+
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+typedef void (GLAD_API_PTR *PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+
+extern PFNGLMULTIDRAWELEMENTSINDIRECTPROC glad_glMultiDrawElementsIndirect;
+#define glMultiDrawElementsIndirect glad_glMultiDrawElementsIndirect
+
+struct GLExtensions {
+    GLint major_version;
+    GLint minor_version;
+    bool  multi_draw_indirect;  // GL 4.3 or GL_ARB_multi_draw_indirect
+};
+
+extern GLExtensions gl_extensions;
+
+// Must be called after gladLoadGL with current context
+void load_gl_extensions(GLADloadfunc load);
+
+bool has_gl_extension(const char* name);
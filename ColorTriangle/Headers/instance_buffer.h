@@ -0,0 +1,38 @@
+#pragma once
+
+#include <glad/gl.h>
+
+// Per-instance data, layout matches instanced vertex shader inputs
+struct InstanceData {
+    GLfloat model[16];  // Model matrix, column-major
+    GLfloat color[4];   // RGBA
+};
+
+// Vertex buffer with per-instance attributes (glVertexAttribDivisor = 1),
+// lets draw any number of mesh copies with a single draw call
+class InstanceBuffer {
+    GLuint  vbo_id;
+    GLsizei capacity;
+    GLsizei count;
+public:
+    // Model matrix takes 4 attribute locations, color takes the next one
+    static const GLuint locations_used = 5;
+
+    InstanceBuffer();
+    InstanceBuffer(const InstanceBuffer& rhs) = delete;
+    InstanceBuffer& operator= (const InstanceBuffer& rhs) = delete;
+    ~InstanceBuffer();
+
+    GLsizei size() const {
+        return count;
+    }
+
+    // Setup per-instance attributes in currently bound vertex array
+    void attach(GLuint first_location) const;
+
+    // Replace instances data, buffer storage grows on demand
+    void upload(const InstanceData* data, GLsizei instances);
+
+    void draw_arrays(GLenum mode, GLint first, GLsizei vertices) const;
+    void draw_elements(GLenum mode, GLsizei indices, GLenum type, const void* offset) const;
+};
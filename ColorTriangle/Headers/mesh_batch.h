@@ -0,0 +1,94 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <shader_reflection.h>
+#include <vector>
+
+// Command layout defined by GL_ARB_draw_indirect
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instance_count;
+    GLuint first_index;
+    GLint  base_vertex;
+    GLuint base_instance;
+};
+
+// Per-draw data, fetched as instanced attribute through base_instance
+struct DrawData {
+    GLfloat transform[4];   // X offset, Y offset, scale, unused
+    GLfloat color[4];       // RGBA
+};
+
+// Packs many meshes into shared vertex/index buffers and submits all draws
+// of one material with single glMultiDrawElementsIndirect call.
+// Without GL 4.3 the same commands are submitted in a loop of
+// glDrawElementsInstancedBaseVertex calls.
+// Vertex format : 3 floats position, 3 floats color
+class MeshBatch {
+    struct MeshRange {
+        GLuint first_index;
+        GLuint index_count;
+        GLint  base_vertex;
+    };
+
+    struct DrawRequest {
+        unsigned int mesh;
+        DrawData     data;
+    };
+
+    struct CommandRange {
+        GLuint first_command;
+        GLuint command_count;
+    };
+
+    GLuint vao_id, vbo_id, ibo_id, draw_data_id, indirect_id;
+    GLuint draw_data_location;
+    bool   use_indirect;
+    mutable GLuint draw_data_first;     // Draw data offset set in vertex array
+
+    std::vector<GLfloat>    vertices;
+    std::vector<GLuint>     indices;
+    std::vector<MeshRange>  meshes;
+
+    std::vector<std::vector<DrawRequest>> requests;    // Per material
+    std::vector<CommandRange>             ranges;      // Per material
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<DrawData>                    draw_data;
+    GLsizei commands_capacity, draw_data_capacity;
+
+    void bind_draw_data(GLuint first) const;
+public:
+    static const GLuint vertex_size = 6;
+    static const VertexAttribute vertex_layout[];
+    static const size_t vertex_layout_size;
+
+    MeshBatch(unsigned int materials);
+    MeshBatch(const MeshBatch& rhs) = delete;
+    MeshBatch& operator= (const MeshBatch& rhs) = delete;
+    ~MeshBatch();
+
+    bool indirect() const {
+        return use_indirect;
+    }
+
+    // Indirect path is used only when supported by context
+    void set_indirect(bool enable);
+
+    // Returns mesh id, meshes can't be added after build()
+    unsigned int add_mesh(const GLfloat* mesh_vertices, GLuint vertex_count,
+                          const GLuint* mesh_indices, GLuint index_count);
+
+    // Upload geometry, per-draw attributes start from draw_data_location
+    void build(GLuint first_draw_data_location);
+
+    // Per frame : clear(), add_draw() for visible objects, upload(),
+    // then bind material state and draw(material) for every material
+    void clear();
+    void add_draw(unsigned int material, unsigned int mesh, const DrawData& data);
+    void upload();
+    void draw(unsigned int material) const;
+
+    GLsizei draws_count() const {
+        return (GLsizei)commands.size();
+    }
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+// FNV-1a, names are hashed once when resolving handles
+inline uint32_t hash_name(const char* name) {
+    uint32_t hash = 2166136261u;
+    for(; *name; ++name) {
+        hash ^= (uint8_t)*name;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Hash only picks the bucket, colliding names are told apart by full comparison
+struct NameHash {
+    size_t operator()(const std::string& name) const {
+        return hash_name(name.c_str());
+    }
+};
+
+struct ShaderVariable {
+    std::string name;
+    GLenum      type;       // GL_FLOAT_VEC3, GL_FLOAT_MAT4, GL_SAMPLER_2D...
+    GLint       size;       // Array size, 1 for non arrays
+    GLint       location;   // -1 for uniforms inside blocks
+    GLint       block;      // Uniform block index, -1 for default block
+};
+
+struct ShaderBlock {
+    std::string name;
+    GLuint      index;
+    GLint       data_size;
+};
+
+// Uniform location with GLSL type checked when resolved,
+// invalid handles keep location -1 which GL ignores
+template<GLenum Type>
+struct UniformHandle {
+    GLint location = -1;
+
+    bool valid() const {
+        return location >= 0;
+    }
+};
+
+inline void set_uniform(UniformHandle<GL_FLOAT> handle, GLfloat value) {
+    glUniform1f(handle.location, value);
+}
+
+inline void set_uniform(UniformHandle<GL_FLOAT_VEC2> handle, const GLfloat* value) {
+    glUniform2fv(handle.location, 1, value);
+}
+
+inline void set_uniform(UniformHandle<GL_FLOAT_VEC3> handle, const GLfloat* value) {
+    glUniform3fv(handle.location, 1, value);
+}
+
+inline void set_uniform(UniformHandle<GL_FLOAT_VEC4> handle, const GLfloat* value) {
+    glUniform4fv(handle.location, 1, value);
+}
+
+inline void set_uniform(UniformHandle<GL_FLOAT_MAT4> handle, const GLfloat* value) {
+    glUniformMatrix4fv(handle.location, 1, GL_FALSE, value);
+}
+
+inline void set_uniform(UniformHandle<GL_INT> handle, GLint value) {
+    glUniform1i(handle.location, value);
+}
+
+inline void set_uniform(UniformHandle<GL_SAMPLER_2D> handle, GLint unit) {
+    glUniform1i(handle.location, unit);
+}
+
+// Describes one glVertexAttribPointer call
+struct VertexAttribute {
+    GLuint    location;
+    GLint     components;
+    GLenum    type;
+    GLboolean normalized;
+    GLsizei   stride;
+    size_t    offset;
+};
+
+// Setup attributes of currently bound vertex array from buffer bound to GL_ARRAY_BUFFER
+void apply_vertex_layout(const VertexAttribute* attributes, size_t count);
+
+// Active uniforms, uniform blocks and attributes of linked program
+class ShaderReflection {
+    std::unordered_map<std::string, ShaderVariable, NameHash> uniforms;
+    std::unordered_map<std::string, ShaderVariable, NameHash> attributes;
+    std::unordered_map<std::string, ShaderBlock, NameHash>    blocks;
+
+    GLint find_uniform_location(const char* name, GLenum type) const;
+public:
+    // Must be called once after successful link
+    void reflect(GLuint program_id);
+
+    const ShaderVariable* uniform(const char* name) const;
+    const ShaderVariable* attribute(const char* name) const;
+    const ShaderBlock*    block(const char* name) const;
+
+    template<GLenum Type>
+    UniformHandle<Type> uniform_handle(const char* name) const {
+        UniformHandle<Type> handle;
+        handle.location = find_uniform_location(name, Type);
+        return handle;
+    }
+
+    // Checks layout against shader inputs: integer inputs fed by float pointers
+    // are errors, unused locations and extra components only warnings
+    bool validate_layout(const VertexAttribute* layout, size_t count) const;
+
+    void print() const;
+};
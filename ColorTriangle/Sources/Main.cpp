@@ -1,8 +1,20 @@
+#include <instance_buffer.h>
+#include <mesh_batch.h>
+#include <gl_extensions.h>
+#include <shader_reflection.h>
+#include <frame_pacing.h>
+#include <gpu_profiler.h>
+#include <gl_call_stats.h>
+#include <alloc_tracker.h>
 #define GLAD_GL_IMPLEMENTATION
 #include <glad/gl.h>
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <algorithm>
 
 using namespace std;
 
@@ -11,6 +23,9 @@ static void error_callback(int error, const char* description)
     fprintf(stderr, "Error: %s\n", description);
 }
 
+// Multi-draw mode : switch between indirect and loop submission
+static bool switch_draw_path = false;
+
 static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
     static bool wireframe = true;
@@ -25,6 +40,9 @@ static void key_callback(GLFWwindow* window, int key, int scancode, int action,
                 glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
             wireframe = !wireframe;
             break;
+        case GLFW_KEY_I:
+            switch_draw_path = true;
+            break;
         }
     }
 }
@@ -40,6 +58,44 @@ static const char* vertex_shader_text =
 "    vertexColor = color;\n"
 "}";
 
+// Stress mode: every triangle copy gets own transform and color
+static const char* instanced_vertex_shader_text = 
+"#version 330 core\n"
+"layout (location = 0) in vec3 position;\n"
+"layout (location = 1) in vec3 color;\n"
+"layout (location = 2) in mat4 model;\n"
+"layout (location = 6) in vec4 instanceColor;\n"
+"out vec3 vertexColor;\n"
+"void main()\n"
+"{\n"
+"    gl_Position = model * vec4(position, 1.0);\n"
+"    vertexColor = color * instanceColor.rgb;\n"
+"}";
+
+// Multi-draw mode: per-draw transform and color come from instanced attributes
+static const char* mdi_vertex_shader_text = 
+"#version 330 core\n"
+"layout (location = 0) in vec3 position;\n"
+"layout (location = 1) in vec3 color;\n"
+"layout (location = 2) in vec4 drawTransform;\n"
+"layout (location = 3) in vec4 drawColor;\n"
+"out vec3 vertexColor;\n"
+"void main()\n"
+"{\n"
+"    gl_Position = vec4(position.xy * drawTransform.z + drawTransform.xy, position.z, 1.0);\n"
+"    vertexColor = color * drawColor.rgb;\n"
+"}";
+
+static const char* mdi_fragment_shader_text = 
+"#version 330 core\n"
+"in vec3 vertexColor;\n"
+"out vec4 color;\n"
+"uniform vec3 materialTint;\n"
+"void main()\n"
+"{\n"
+"    color = vec4(vertexColor * materialTint, 1.0f);\n"
+"}\n";
+
 static const char* fragment_shader_text = 
 "#version 330 core\n"
 "in vec3 vertexColor;\n"
@@ -56,9 +112,137 @@ GLfloat vertices[] = {
      0.0f,  0.5f, 0.0f,  0.0f, 0.0f, 1.0f    // Top
 };
 
+// Data array - vertices
+//  ________________________________________________
+// |        Vertex 1       |        Vertex 2       |
+// |___________|___________|___________|___________|
+// | X | Y | Z | R | G | B | X | Y | Z | R | G | B |
+// |___|___|___|___|___|___|___|___|___|___|___|___|
+// | 0 | 1 | 3 | 4 | 5 | 6 | 7 | 8 | 9 | 0 | 1 | 2 |
+//
+//  <---------------------> <--------------------->
+//           step = 6 * sizeof(float)
+static const VertexAttribute vertex_layout[] = {
+    // Location, size, type, normalize, step, offset
+    { 0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), 0                   },   // Position
+    { 1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), 3 * sizeof(GLfloat) }    // Color
+};
+
+// Place instances on a square grid covering the viewport
+static void generate_instances(vector<InstanceData>& instances, GLsizei count)
+{
+    instances.resize(count);
+    const int side = (int)ceil(sqrt((double)count));
+    const GLfloat cell = 2.0f / side;
+
+    for(GLsizei i = 0; i < count; ++i) {
+        const int row = i / side, col = i % side;
+        InstanceData& instance = instances[i];
+        memset(instance.model, 0, sizeof(instance.model));
+        instance.model[0]  = cell;                          // Scale X
+        instance.model[5]  = cell;                          // Scale Y
+        instance.model[10] = 1.0f;
+        instance.model[12] = -1.0f + cell * (col + 0.5f);   // Translate X
+        instance.model[13] = -1.0f + cell * (row + 0.5f);   // Translate Y
+        instance.model[15] = 1.0f;
+
+        instance.color[0] = (GLfloat)col / side;
+        instance.color[1] = (GLfloat)row / side;
+        instance.color[2] = 1.0f - (GLfloat)col / side;
+        instance.color[3] = 1.0f;
+    }
+}
+
+// Distinct polygon meshes (3 to 8 sides) packed into one batch
+static void generate_meshes(MeshBatch& batch, vector<DrawData>& objects, unsigned int count)
+{
+    vector<GLfloat> mesh_vertices;
+    vector<GLuint>  mesh_indices;
+    const int side = (int)ceil(sqrt((double)count));
+    const GLfloat cell = 2.0f / side;
+    const GLfloat pi = 3.14159265f;
+
+    objects.resize(count);
+    for(unsigned int i = 0; i < count; ++i) {
+        const GLuint sides = 3 + i % 6;
+        const GLfloat radius = 0.35f + 0.015f * ((i * 7) % 10);
+
+        // Center vertex, then ring vertices
+        mesh_vertices.assign({ 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f });
+        mesh_indices.clear();
+        for(GLuint k = 0; k < sides; ++k) {
+            GLfloat angle = 2.0f * pi * k / sides;
+            mesh_vertices.insert(mesh_vertices.end(), {
+                radius * cos(angle), radius * sin(angle), 0.0f,
+                0.5f + 0.5f * cos(angle), 0.5f + 0.5f * sin(angle), 0.5f
+            });
+            mesh_indices.insert(mesh_indices.end(), { 0, k + 1, (k + 1) % sides + 1 });
+        }
+        batch.add_mesh(mesh_vertices.data(), sides + 1, mesh_indices.data(), (GLuint)mesh_indices.size());
+
+        const int row = i / side, col = i % side;
+        DrawData& object = objects[i];
+        object.transform[0] = -1.0f + cell * (col + 0.5f);
+        object.transform[1] = -1.0f + cell * (row + 0.5f);
+        object.transform[2] = cell;
+        object.transform[3] = 0.0f;
+        object.color[0] = 1.0f;
+        object.color[1] = (GLfloat)row / side;
+        object.color[2] = (GLfloat)col / side;
+        object.color[3] = 1.0f;
+    }
+}
+
 int main(int argc, char** argv)
 {
     cout << "Application started..." << endl;
+
+    // Stress mode      : --stress [instances count]
+    // Multi-draw mode  : --mdi [meshes count] [--no-indirect]
+    // Frame pacing     : --vsync off|on|adaptive, --fps N, --on-demand, --pacing-report
+    // Allocation sites : --alloc-sites [top sites count], needs TRACK_ALLOCATIONS build
+    // GL call stats    : --gl-calls, debug builds
+    FramePacingConfig pacing = default_frame_pacing();
+    GLsizei stress_instances = 0;
+    unsigned int mdi_meshes = 0;
+    bool allow_indirect = true;
+    bool gpu_profile = false;
+    size_t allocation_sites = 0;
+    bool gl_calls = false;
+    for(int i = 1; i < argc; ++i) {
+        if(strcmp(argv[i], "--stress") == 0) {
+            stress_instances = 10000;
+            if(i + 1 < argc && atoi(argv[i + 1]) > 0)
+                stress_instances = atoi(argv[++i]);
+        } else if(strcmp(argv[i], "--mdi") == 0) {
+            mdi_meshes = 5000;
+            if(i + 1 < argc && atoi(argv[i + 1]) > 0)
+                mdi_meshes = atoi(argv[++i]);
+        } else if(strcmp(argv[i], "--no-indirect") == 0) {
+            allow_indirect = false;
+        } else if(strcmp(argv[i], "--gpu-profile") == 0) {
+            gpu_profile = true;
+        } else if(strcmp(argv[i], "--gl-calls") == 0) {
+            gl_calls = true;
+        } else if(strcmp(argv[i], "--alloc-sites") == 0) {
+            allocation_sites = 10;
+            if(i + 1 < argc && atoi(argv[i + 1]) > 0)
+                allocation_sites = atoi(argv[++i]);
+        } else {
+            parse_frame_pacing_arg(i, argc, argv, pacing);
+        }
+    }
+    const bool stress_mode = stress_instances > 0;
+    const bool mdi_mode = !stress_mode && mdi_meshes > 0;
+    const bool benchmark_mode = stress_mode || mdi_mode;
+
+    if(allocation_sites > 0) {
+        if(allocation_tracking())
+            capture_allocation_sites(true);
+        else
+            cerr << "Error : allocation tracking is not compiled in, configure with -DTRACK_ALLOCATIONS=ON" << endl;
+    }
+
     if (!glfwInit())
         exit(EXIT_FAILURE);
 
@@ -83,6 +267,15 @@ int main(int argc, char** argv)
 
     // Initialize OpenGL
     gladLoadGL(glfwGetProcAddress);
+    load_gl_extensions(glfwGetProcAddress);
+
+    if(gl_calls && !install_gl_call_stats())
+        cerr << "Error : GL call statistics are compiled in debug builds only" << endl;
+    cout << "OpenGL version : " << gl_extensions.major_version << "." << gl_extensions.minor_version << endl;
+
+    // Don't wait for vsync, frame time must show real rendering cost
+    if(benchmark_mode)
+        glfwSwapInterval(0);
 
     int width, height;
     glfwGetFramebufferSize(window, &width, &height);
@@ -102,7 +295,12 @@ int main(int argc, char** argv)
 
     cout << "Creating vertex shader..." << endl;
     GLuint vertex_shader_id = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex_shader_id, 1, &vertex_shader_text, NULL);
+    const char* vertex_shader_source = vertex_shader_text;
+    if(stress_mode)
+        vertex_shader_source = instanced_vertex_shader_text;
+    if(mdi_mode)
+        vertex_shader_source = mdi_vertex_shader_text;
+    glShaderSource(vertex_shader_id, 1, &vertex_shader_source, NULL);
     glCompileShader(vertex_shader_id);
     glGetShaderiv(vertex_shader_id, GL_COMPILE_STATUS, &status);
 
@@ -116,7 +314,8 @@ int main(int argc, char** argv)
 
     cout << "Crating fragment shader..." << endl;
     GLuint fragment_shader_id = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment_shader_id, 1, &fragment_shader_text, NULL);
+    const char* fragment_shader_source = mdi_mode ? mdi_fragment_shader_text : fragment_shader_text;
+    glShaderSource(fragment_shader_id, 1, &fragment_shader_source, NULL);
     glCompileShader(fragment_shader_id);
     glGetShaderiv(fragment_shader_id, GL_COMPILE_STATUS, &status);
 
@@ -145,56 +344,170 @@ int main(int argc, char** argv)
 
     cout << "Shader program created" << endl;
 
+    ShaderReflection reflection;
+    reflection.reflect(shader_program_id);
+#ifdef _DEBUG
+    reflection.print();
+#endif
+
     glUseProgram(shader_program_id);
     glDeleteShader(vertex_shader_id);
     glDeleteShader(fragment_shader_id);
 
-    // Data array - vertices
-    //  ________________________________________________
-    // |        Vertex 1       |        Vertex 2       |
-    // |___________|___________|___________|___________|
-    // | X | Y | Z | R | G | B | X | Y | Z | R | G | B |
-    // |___|___|___|___|___|___|___|___|___|___|___|___|
-    // | 0 | 1 | 3 | 4 | 5 | 6 | 7 | 8 | 9 | 0 | 1 | 2 |
-    //
-    //  <---------------------> <--------------------->
-    //           step = 6 * sizeof(float)
     glBindVertexArray(vao_id);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(
-        0,                             // Input layout position in vertex shader
-        3,                             // Input vector size
-        GL_FLOAT,                      // Data type
-        GL_FALSE,                      // No need to normalize data
-        6 * sizeof(GL_FLOAT),          // Data step
-        (GLvoid*)0                     // Start data offset
-    );
-
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(
-        1,                             // Input layout position in vertex shader
-        3,                             // Input vector size
-        GL_FLOAT,                      // Data type
-        GL_FALSE,                      // No need to normalize data
-        6 * sizeof(GL_FLOAT),          // Data step
-        (GLvoid*)(3 * sizeof(GLfloat)) // Start data offset
-    );
-
-    // Main loop
+    apply_vertex_layout(vertex_layout, sizeof(vertex_layout) / sizeof(vertex_layout[0]));
+
+    const bool layout_valid = mdi_mode ?
+        reflection.validate_layout(MeshBatch::vertex_layout, MeshBatch::vertex_layout_size) :
+        reflection.validate_layout(vertex_layout, sizeof(vertex_layout) / sizeof(vertex_layout[0]));
+    if(!layout_valid) {
+        cerr << "Error : vertex layout doesn't match shader inputs" << endl;
+        return EXIT_FAILURE;
+    }
+
+    // Per-instance attributes : model matrix (locations 2-5), color (location 6)
+    InstanceBuffer instances;
+    if(stress_mode) {
+        vector<InstanceData> instances_data;
+        generate_instances(instances_data, stress_instances);
+        instances.attach(2);
+        instances.upload(instances_data.data(), stress_instances);
+        cout << "Stress mode : " << stress_instances << " instances" << endl;
+    }
+
+    // Every mesh drawn once per frame, materials differ by tint uniform
+    const unsigned int materials = 2;
+    const GLfloat material_tints[materials][3] = {
+        { 1.0f, 1.0f, 1.0f },
+        { 0.4f, 0.9f, 0.6f }
+    };
+    UniformHandle<GL_FLOAT_VEC3> material_tint;
+    if(mdi_mode)
+        material_tint = reflection.uniform_handle<GL_FLOAT_VEC3>("materialTint");
+    MeshBatch batch(materials);
+    vector<DrawData> objects;
+    if(mdi_mode) {
+        generate_meshes(batch, objects, mdi_meshes);
+        batch.build(2);
+        batch.set_indirect(allow_indirect);
+        cout << "Multi-draw mode : " << mdi_meshes << " meshes, "
+             << (gl_extensions.multi_draw_indirect ? "" : "indirect draws not supported, ")
+             << "press I to switch draw path" << endl;
+    }
+
+    double report_time = glfwGetTime();
+    double submit_time = 0.0;
+    unsigned int frames = 0;
+
+    // Frames after warm up must not allocate : buffers and batches are sized by then
+    const unsigned int warm_up_frames = 120;
+    unsigned int frame_number = 0;
+    unsigned int allocating_frames = 0;
+    size_t report_allocations = 0;
+
+    // Main loop, benchmarks redraw continuously, plain triangle only on events in on-demand mode
+    FramePacer pacer(pacing);
+    GpuProfiler gpu_profiler(gpu_profile);
+    double profile_report_time = glfwGetTime();
     while (!glfwWindowShouldClose(window))
     {
-        glfwPollEvents();
+        const AllocationStats frame_start = allocation_stats();
+        pacer.wait_events(benchmark_mode);
 
         // Render
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-        glDrawArrays(GL_TRIANGLES, 0, 3);
+        gpu_profiler.begin_frame();
+        {
+            GpuScope frame_scope(gpu_profiler, "frame");
+            {
+                GpuScope clear_scope(gpu_profiler, "clear");
+                glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT);
+            }
+            if(stress_mode) {
+                GpuScope draw_scope(gpu_profiler, "instances");
+                instances.draw_arrays(GL_TRIANGLES, 0, 3);
+            } else if(mdi_mode) {
+                if(switch_draw_path) {
+                    batch.set_indirect(!batch.indirect());
+                    switch_draw_path = false;
+                }
+
+                // CPU cost of building and submitting draws, without swap
+                double submit_start = glfwGetTime();
+                {
+                    AllocationScope allocation_scope("build draws");
+                    batch.clear();
+                    for(unsigned int i = 0; i < mdi_meshes; ++i)
+                        batch.add_draw(i % materials, i, objects[i]);
+                }
+                {
+                    AllocationScope allocation_scope("upload draws");
+                    GpuScope upload_scope(gpu_profiler, "upload");
+                    batch.upload();
+                }
+                for(unsigned int material = 0; material < materials; ++material) {
+                    GpuScope material_scope(gpu_profiler, "material");
+                    set_uniform(material_tint, material_tints[material]);
+                    batch.draw(material);
+                }
+                submit_time += glfwGetTime() - submit_start;
+            } else {
+                GpuScope draw_scope(gpu_profiler, "triangle");
+                glDrawArrays(GL_TRIANGLES, 0, 3);
+            }
+        }
+        gpu_profiler.end_frame();
+        gl_call_stats_end_frame();
 
         glfwSwapBuffers(window);
+        pacer.end_frame();
+
+        const AllocationStats frame_allocations = allocation_delta(frame_start, allocation_stats());
+        report_allocations += frame_allocations.allocations;
+        if(++frame_number > warm_up_frames && frame_allocations.allocations > 0)
+            ++allocating_frames;
+
+        if(gpu_profiler.is_enabled() && glfwGetTime() - profile_report_time >= 2.0) {
+            gpu_profiler.print(cout);
+            profile_report_time = glfwGetTime();
+        }
+
+        // Report average frame time once per second
+        if(benchmark_mode) {
+            ++frames;
+            double now = glfwGetTime();
+            if(now - report_time >= 1.0) {
+                double frame_time = (now - report_time) / frames;
+                if(stress_mode)
+                    cout << "Instances : " << instances.size();
+                else
+                    cout << "Draws : " << batch.draws_count()
+                         << (batch.indirect() ? " (multi-draw indirect)" : " (draw loop)")
+                         << ", CPU submit time : " << submit_time / frames * 1000.0 << " ms";
+                cout << ", frame time : " << frame_time * 1000.0 << " ms"
+                     << ", FPS : " << frames / (now - report_time);
+                if(allocation_tracking())
+                    cout << ", allocations/frame : " << (double)report_allocations / frames;
+                cout << endl;
+                report_time = now;
+                submit_time = 0.0;
+                frames = 0;
+                report_allocations = 0;
+            }
+        }
     }
 
+    if(allocation_sites > 0 && allocation_tracking())
+        print_allocation_report(cout, allocation_sites);
+
+    // Benchmark fails when steady state frames allocate
+    const bool allocations_failed = benchmark_mode && allocating_frames > 0;
+    if(allocations_failed)
+        cerr << "Error : " << allocating_frames << " of " << frame_number - min(frame_number, warm_up_frames)
+             << " frames after warm up allocated memory, run with --alloc-sites to find where" << endl;
+
     // Shutdown
     glfwDestroyWindow(window);
     glfwTerminate();
-    exit(EXIT_SUCCESS);
+    exit(allocations_failed ? EXIT_FAILURE : EXIT_SUCCESS);
 }
@@ -0,0 +1,255 @@
+#include <alloc_tracker.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#if defined(__GLIBC__) || defined(__APPLE__)
+#include <execinfo.h>
+#define HAS_BACKTRACE 1
+#endif
+
+namespace {
+
+std::atomic<size_t> allocations_count(0);
+std::atomic<size_t> frees_count(0);
+std::atomic<size_t> allocated_bytes(0);
+std::atomic<bool>   capture_sites(false);
+
+struct NamedScope {
+    const char*     name;
+    AllocationStats stats;
+    size_t          entries;
+};
+
+std::mutex              scopes_mutex;
+std::vector<NamedScope> scopes;
+
+}
+
+#if defined(TRACK_ALLOCATIONS)
+
+namespace {
+
+// Call stacks are kept in fixed table, hook must not allocate itself
+const int    site_depth = 10;
+const int    skipped_frames = 2;    // record_site() and operator new
+const size_t max_sites = 4096;
+
+struct Site {
+    size_t hash;
+    int    depth;
+    void*  frames[site_depth];
+    size_t allocations;
+    size_t bytes;
+};
+
+std::mutex sites_mutex;
+Site       sites[max_sites];
+size_t     sites_count = 0;
+size_t     sites_lost = 0;
+
+// Allocations made while site is recorded (backtrace loads unwinder) are not recorded
+thread_local bool recording = false;
+
+void record_site(size_t size) {
+#if defined(HAS_BACKTRACE)
+    if(recording)
+        return;
+    recording = true;
+
+    void* frames[site_depth + skipped_frames];
+    const int depth = backtrace(frames, site_depth + skipped_frames) - skipped_frames;
+    if(depth > 0) {
+        size_t hash = 0;
+        for(int i = 0; i < depth; ++i)
+            hash = hash * 31 + (size_t)frames[skipped_frames + i];
+
+        std::lock_guard<std::mutex> lock(sites_mutex);
+        // Open addressing, table is never shrunk
+        for(size_t probe = 0; probe < max_sites; ++probe) {
+            Site& site = sites[(hash + probe) % max_sites];
+            if(site.allocations == 0) {
+                if(sites_count * 4 >= max_sites * 3) {
+                    ++sites_lost;
+                    break;
+                }
+                site.hash = hash;
+                site.depth = depth;
+                memcpy(site.frames, frames + skipped_frames, sizeof(void*) * depth);
+                ++sites_count;
+            } else if(site.hash != hash || site.depth != depth ||
+                      memcmp(site.frames, frames + skipped_frames, sizeof(void*) * depth) != 0) {
+                continue;
+            }
+            ++site.allocations;
+            site.bytes += size;
+            break;
+        }
+    }
+    recording = false;
+#else
+    (void)size;
+#endif
+}
+
+}
+
+static void* tracked_allocate(size_t size, size_t alignment) {
+    allocations_count.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if(capture_sites.load(std::memory_order_relaxed))
+        record_site(size);
+
+    if(size == 0)
+        size = 1;
+    void* pointer = NULL;
+    if(alignment > alignof(std::max_align_t)) {
+        if(posix_memalign(&pointer, alignment, size) != 0)
+            pointer = NULL;
+    } else {
+        pointer = malloc(size);
+    }
+    return pointer;
+}
+
+static void tracked_free(void* pointer) {
+    if(!pointer)
+        return;
+    frees_count.fetch_add(1, std::memory_order_relaxed);
+    free(pointer);
+}
+
+void* operator new(size_t size) {
+    void* pointer = tracked_allocate(size, 0);
+    if(!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new[](size_t size) {
+    void* pointer = tracked_allocate(size, 0);
+    if(!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    void* pointer = tracked_allocate(size, (size_t)alignment);
+    if(!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    void* pointer = tracked_allocate(size, (size_t)alignment);
+    if(!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return tracked_allocate(size, 0);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return tracked_allocate(size, 0);
+}
+
+void operator delete(void* pointer) noexcept                              { tracked_free(pointer); }
+void operator delete[](void* pointer) noexcept                            { tracked_free(pointer); }
+void operator delete(void* pointer, size_t) noexcept                      { tracked_free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept                    { tracked_free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept            { tracked_free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept          { tracked_free(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept    { tracked_free(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept  { tracked_free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept       { tracked_free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept     { tracked_free(pointer); }
+
+bool allocation_tracking() {
+    return true;
+}
+
+#else
+
+bool allocation_tracking() {
+    return false;
+}
+
+#endif
+
+AllocationStats allocation_stats() {
+    return {
+        allocations_count.load(std::memory_order_relaxed),
+        frees_count.load(std::memory_order_relaxed),
+        allocated_bytes.load(std::memory_order_relaxed)
+    };
+}
+
+AllocationStats allocation_delta(const AllocationStats& begin, const AllocationStats& end) {
+    return { end.allocations - begin.allocations, end.frees - begin.frees, end.bytes - begin.bytes };
+}
+
+void capture_allocation_sites(bool enable) {
+    capture_sites.store(enable, std::memory_order_relaxed);
+}
+
+AllocationScope::~AllocationScope() {
+    const AllocationStats delta = allocation_delta(start, allocation_stats());
+    std::lock_guard<std::mutex> lock(scopes_mutex);
+    for(NamedScope& scope : scopes) {
+        if(scope.name == name) {
+            scope.stats.allocations += delta.allocations;
+            scope.stats.frees += delta.frees;
+            scope.stats.bytes += delta.bytes;
+            ++scope.entries;
+            return;
+        }
+    }
+    scopes.push_back({ name, delta, 1 });
+}
+
+void print_allocation_report(std::ostream& out, size_t top_sites) {
+    // Report itself allocates, those allocations must not change tables being read
+    const bool capturing = capture_sites.exchange(false);
+
+    const AllocationStats total = allocation_stats();
+    out << "Allocations : " << total.allocations << ", frees : " << total.frees
+        << ", bytes : " << total.bytes << std::endl;
+
+    {
+        std::lock_guard<std::mutex> lock(scopes_mutex);
+        for(const NamedScope& scope : scopes)
+            out << "  " << scope.name << " : " << scope.stats.allocations << " allocations, "
+                << scope.stats.bytes << " bytes in " << scope.entries << " entries" << std::endl;
+    }
+
+    // Site table exists only with hook compiled in
+#if defined(TRACK_ALLOCATIONS) && defined(HAS_BACKTRACE)
+    std::vector<const Site*> sorted;
+    {
+        std::lock_guard<std::mutex> lock(sites_mutex);
+        for(const Site& site : sites)
+            if(site.allocations) sorted.push_back(&site);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const Site* lhs, const Site* rhs) {
+        return lhs->allocations > rhs->allocations;
+    });
+    if(sorted.size() > top_sites)
+        sorted.resize(top_sites);
+
+    for(const Site* site : sorted) {
+        out << "Site : " << site->allocations << " allocations, " << site->bytes << " bytes" << std::endl;
+        char** symbols = backtrace_symbols(site->frames, site->depth);
+        for(int i = 0; symbols && i < site->depth; ++i)
+            out << "    " << symbols[i] << std::endl;
+        free(symbols);
+    }
+    if(sites_lost)
+        out << "Sites table full, " << sites_lost << " allocations without site" << std::endl;
+#else
+    (void)top_sites;
+#endif
+
+    capture_sites.store(capturing);
+}
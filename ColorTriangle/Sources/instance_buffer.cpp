@@ -0,0 +1,64 @@
+#include <instance_buffer.h>
+#include <cstddef>    // offsetof
+
+InstanceBuffer::InstanceBuffer() : vbo_id(0), capacity(0), count(0) {
+    glGenBuffers(1, &vbo_id);
+}
+
+InstanceBuffer::~InstanceBuffer() {
+    if (vbo_id) glDeleteBuffers(1, &vbo_id);
+}
+
+void InstanceBuffer::attach(GLuint first_location) const {
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
+
+    // mat4 attribute is passed as 4 vec4 columns
+    for(GLuint column = 0; column < 4; ++column) {
+        GLuint location = first_location + column;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(
+            location,
+            4,
+            GL_FLOAT,
+            GL_FALSE,
+            sizeof(InstanceData),
+            (GLvoid*)(offsetof(InstanceData, model) + column * 4 * sizeof(GLfloat))
+        );
+        glVertexAttribDivisor(location, 1);
+    }
+
+    GLuint color_location = first_location + 4;
+    glEnableVertexAttribArray(color_location);
+    glVertexAttribPointer(
+        color_location,
+        4,
+        GL_FLOAT,
+        GL_FALSE,
+        sizeof(InstanceData),
+        (GLvoid*)offsetof(InstanceData, color)
+    );
+    glVertexAttribDivisor(color_location, 1);
+}
+
+void InstanceBuffer::upload(const InstanceData* data, GLsizei instances) {
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
+    if(instances > capacity) {
+        glBufferData(GL_ARRAY_BUFFER, sizeof(InstanceData) * instances, data, GL_DYNAMIC_DRAW);
+        capacity = instances;
+    } else {
+        // Orphan old storage, so driver doesn't wait for previous draws
+        glBufferData(GL_ARRAY_BUFFER, sizeof(InstanceData) * capacity, NULL, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(InstanceData) * instances, data);
+    }
+    count = instances;
+}
+
+void InstanceBuffer::draw_arrays(GLenum mode, GLint first, GLsizei vertices) const {
+    if(count > 0)
+        glDrawArraysInstanced(mode, first, vertices, count);
+}
+
+void InstanceBuffer::draw_elements(GLenum mode, GLsizei indices, GLenum type, const void* offset) const {
+    if(count > 0)
+        glDrawElementsInstanced(mode, indices, type, offset, count);
+}
@@ -0,0 +1,167 @@
+#include <mesh_batch.h>
+#include <gl_extensions.h>
+#include <cstddef>    // offsetof
+
+const VertexAttribute MeshBatch::vertex_layout[] = {
+    { 0, 3, GL_FLOAT, GL_FALSE, vertex_size * sizeof(GLfloat), 0                   },   // Position
+    { 1, 3, GL_FLOAT, GL_FALSE, vertex_size * sizeof(GLfloat), 3 * sizeof(GLfloat) }    // Color
+};
+
+const size_t MeshBatch::vertex_layout_size = sizeof(vertex_layout) / sizeof(vertex_layout[0]);
+
+MeshBatch::MeshBatch(unsigned int materials) :
+    vao_id(0), vbo_id(0), ibo_id(0), draw_data_id(0), indirect_id(0),
+    draw_data_location(0), use_indirect(gl_extensions.multi_draw_indirect), draw_data_first(0),
+    requests(materials), ranges(materials),
+    commands_capacity(0), draw_data_capacity(0) {
+    glGenVertexArrays(1, &vao_id);
+    glGenBuffers(1, &vbo_id);
+    glGenBuffers(1, &ibo_id);
+    glGenBuffers(1, &draw_data_id);
+    glGenBuffers(1, &indirect_id);
+}
+
+MeshBatch::~MeshBatch() {
+    GLuint buffers[] = { vbo_id, ibo_id, draw_data_id, indirect_id };
+    glDeleteBuffers(4, buffers);
+    glDeleteVertexArrays(1, &vao_id);
+}
+
+void MeshBatch::set_indirect(bool enable) {
+    use_indirect = enable && gl_extensions.multi_draw_indirect;
+}
+
+unsigned int MeshBatch::add_mesh(const GLfloat* mesh_vertices, GLuint vertex_count,
+                                 const GLuint* mesh_indices, GLuint index_count) {
+    MeshRange range;
+    range.first_index = (GLuint)indices.size();
+    range.index_count = index_count;
+    range.base_vertex = (GLint)(vertices.size() / vertex_size);
+
+    vertices.insert(vertices.end(), mesh_vertices, mesh_vertices + vertex_count * vertex_size);
+    indices.insert(indices.end(), mesh_indices, mesh_indices + index_count);
+    meshes.push_back(range);
+    return (unsigned int)meshes.size() - 1;
+}
+
+void MeshBatch::build(GLuint first_draw_data_location) {
+    draw_data_location = first_draw_data_location;
+
+    glBindVertexArray(vao_id);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_id);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * indices.size(), indices.data(), GL_STATIC_DRAW);
+
+    apply_vertex_layout(vertex_layout, vertex_layout_size);
+
+    glEnableVertexAttribArray(draw_data_location);
+    glVertexAttribDivisor(draw_data_location, 1);
+    glEnableVertexAttribArray(draw_data_location + 1);
+    glVertexAttribDivisor(draw_data_location + 1, 1);
+    bind_draw_data(0);
+
+    // Geometry stays in GPU buffers only
+    vertices.clear();
+    vertices.shrink_to_fit();
+    indices.clear();
+    indices.shrink_to_fit();
+}
+
+void MeshBatch::bind_draw_data(GLuint first) const {
+    const GLsizei stride = sizeof(DrawData);
+    const size_t  offset = (size_t)first * stride;
+    glBindBuffer(GL_ARRAY_BUFFER, draw_data_id);
+    draw_data_first = first;
+    glVertexAttribPointer(draw_data_location, 4, GL_FLOAT, GL_FALSE, stride,
+                          (GLvoid*)(offset + offsetof(DrawData, transform)));
+    glVertexAttribPointer(draw_data_location + 1, 4, GL_FLOAT, GL_FALSE, stride,
+                          (GLvoid*)(offset + offsetof(DrawData, color)));
+}
+
+void MeshBatch::clear() {
+    // Keep capacity, steady state frames don't allocate
+    for(size_t material = 0; material < requests.size(); ++material)
+        requests[material].clear();
+}
+
+void MeshBatch::add_draw(unsigned int material, unsigned int mesh, const DrawData& data) {
+    requests[material].push_back({ mesh, data });
+}
+
+void MeshBatch::upload() {
+    commands.clear();
+    draw_data.clear();
+
+    // Commands of every material are placed one after another,
+    // base_instance points to draw data of every command
+    for(size_t material = 0; material < requests.size(); ++material) {
+        ranges[material].first_command = (GLuint)commands.size();
+        for(const DrawRequest& request : requests[material]) {
+            const MeshRange& mesh = meshes[request.mesh];
+            DrawElementsIndirectCommand command;
+            command.count          = mesh.index_count;
+            command.instance_count = 1;
+            command.first_index    = mesh.first_index;
+            command.base_vertex    = mesh.base_vertex;
+            command.base_instance  = (GLuint)draw_data.size();
+            commands.push_back(command);
+            draw_data.push_back(request.data);
+        }
+        ranges[material].command_count = (GLuint)commands.size() - ranges[material].first_command;
+    }
+
+    // Orphan old storage, previous frame may still read it
+    const GLsizei draws = (GLsizei)draw_data.size();
+    glBindBuffer(GL_ARRAY_BUFFER, draw_data_id);
+    if(draws > draw_data_capacity)
+        draw_data_capacity = draws;
+    glBufferData(GL_ARRAY_BUFFER, sizeof(DrawData) * draw_data_capacity, NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(DrawData) * draws, draw_data.data());
+
+    if(use_indirect) {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_id);
+        if(draws > commands_capacity)
+            commands_capacity = draws;
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawElementsIndirectCommand) * commands_capacity, NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(DrawElementsIndirectCommand) * draws, commands.data());
+    }
+}
+
+void MeshBatch::draw(unsigned int material) const {
+    const CommandRange& range = ranges[material];
+    if(range.command_count == 0)
+        return;
+
+    glBindVertexArray(vao_id);
+
+    if(use_indirect) {
+        // Indirect path selects per-draw data by base_instance, from buffer start,
+        // fallback draws leave offset of their last command
+        if(draw_data_first != 0)
+            bind_draw_data(0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_id);
+        glMultiDrawElementsIndirect(
+            GL_TRIANGLES,
+            GL_UNSIGNED_INT,
+            (const void*)(range.first_command * sizeof(DrawElementsIndirectCommand)),
+            range.command_count,
+            0                   // Tightly packed commands
+        );
+        return;
+    }
+
+    // GL 3.3 has no base instance, per-draw data is selected by attribute offset
+    for(GLuint i = range.first_command, end = i + range.command_count; i < end; ++i) {
+        const DrawElementsIndirectCommand& command = commands[i];
+        bind_draw_data(command.base_instance);
+        glDrawElementsInstancedBaseVertex(
+            GL_TRIANGLES,
+            command.count,
+            GL_UNSIGNED_INT,
+            (const void*)(command.first_index * sizeof(GLuint)),
+            command.instance_count,
+            command.base_vertex
+        );
+    }
+}
@@ -0,0 +1,176 @@
+#include <shader_reflection.h>
+#include <iostream>   // cout, cerr
+
+using namespace std;
+
+// Vector components and occupied locations of attribute type
+static void attribute_shape(GLenum type, GLint* components, GLint* locations, bool* integer) {
+    *locations = 1;
+    *integer = false;
+    switch(type) {
+    case GL_FLOAT:              *components = 1; break;
+    case GL_FLOAT_VEC2:         *components = 2; break;
+    case GL_FLOAT_VEC3:         *components = 3; break;
+    case GL_FLOAT_VEC4:         *components = 4; break;
+    case GL_FLOAT_MAT2:         *components = 2; *locations = 2; break;
+    case GL_FLOAT_MAT3:         *components = 3; *locations = 3; break;
+    case GL_FLOAT_MAT4:         *components = 4; *locations = 4; break;
+    case GL_INT:
+    case GL_UNSIGNED_INT:       *components = 1; *integer = true; break;
+    case GL_INT_VEC2:
+    case GL_UNSIGNED_INT_VEC2:  *components = 2; *integer = true; break;
+    case GL_INT_VEC3:
+    case GL_UNSIGNED_INT_VEC3:  *components = 3; *integer = true; break;
+    case GL_INT_VEC4:
+    case GL_UNSIGNED_INT_VEC4:  *components = 4; *integer = true; break;
+    default:                    *components = 4; break;
+    }
+}
+
+// Arrays are reported as "name[0]", lookups use plain name
+static string base_name(const GLchar* name, GLsizei length) {
+    string result(name, length);
+    size_t bracket = result.find('[');
+    if(bracket != string::npos)
+        result.resize(bracket);
+    return result;
+}
+
+void apply_vertex_layout(const VertexAttribute* attributes, size_t count) {
+    for(size_t i = 0; i < count; ++i) {
+        const VertexAttribute& attribute = attributes[i];
+        glEnableVertexAttribArray(attribute.location);
+        glVertexAttribPointer(
+            attribute.location,
+            attribute.components,
+            attribute.type,
+            attribute.normalized,
+            attribute.stride,
+            (GLvoid*)attribute.offset
+        );
+    }
+}
+
+void ShaderReflection::reflect(GLuint program_id) {
+    const GLsizei max_name_length = 256;
+    GLchar name[max_name_length];
+    GLsizei length;
+    GLint count;
+
+    uniforms.clear();
+    attributes.clear();
+    blocks.clear();
+
+    glGetProgramiv(program_id, GL_ACTIVE_UNIFORMS, &count);
+    for(GLint i = 0; i < count; ++i) {
+        ShaderVariable variable;
+        glGetActiveUniform(program_id, i, max_name_length, &length, &variable.size, &variable.type, name);
+        GLuint index = i;
+        glGetActiveUniformsiv(program_id, 1, &index, GL_UNIFORM_BLOCK_INDEX, &variable.block);
+        variable.location = glGetUniformLocation(program_id, name);
+        variable.name = base_name(name, length);
+        uniforms[variable.name] = variable;
+    }
+
+    glGetProgramiv(program_id, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    for(GLint i = 0; i < count; ++i) {
+        ShaderBlock block;
+        glGetActiveUniformBlockName(program_id, i, max_name_length, &length, name);
+        glGetActiveUniformBlockiv(program_id, i, GL_UNIFORM_BLOCK_DATA_SIZE, &block.data_size);
+        block.index = i;
+        block.name = string(name, length);
+        blocks[block.name] = block;
+    }
+
+    glGetProgramiv(program_id, GL_ACTIVE_ATTRIBUTES, &count);
+    for(GLint i = 0; i < count; ++i) {
+        ShaderVariable variable;
+        glGetActiveAttrib(program_id, i, max_name_length, &length, &variable.size, &variable.type, name);
+        variable.location = glGetAttribLocation(program_id, name);
+        variable.block = -1;
+        variable.name = base_name(name, length);
+        // Built-in inputs (gl_VertexID...) have no location
+        if(variable.location >= 0)
+            attributes[variable.name] = variable;
+    }
+}
+
+const ShaderVariable* ShaderReflection::uniform(const char* name) const {
+    auto it = uniforms.find(name);
+    return it != uniforms.end() ? &it->second : NULL;
+}
+
+const ShaderVariable* ShaderReflection::attribute(const char* name) const {
+    auto it = attributes.find(name);
+    return it != attributes.end() ? &it->second : NULL;
+}
+
+const ShaderBlock* ShaderReflection::block(const char* name) const {
+    auto it = blocks.find(name);
+    return it != blocks.end() ? &it->second : NULL;
+}
+
+GLint ShaderReflection::find_uniform_location(const char* name, GLenum type) const {
+    const ShaderVariable* variable = uniform(name);
+    if(!variable) {
+        // Unused uniforms are removed by compiler, this is not an error
+        cout << "Warning : uniform " << name << " is not active" << endl;
+        return -1;
+    }
+    if(variable->type != type) {
+        cerr << "Error : uniform " << name << " type mismatch, shader type 0x"
+             << hex << variable->type << ", handle type 0x" << type << dec << endl;
+        return -1;
+    }
+    return variable->location;
+}
+
+bool ShaderReflection::validate_layout(const VertexAttribute* layout, size_t count) const {
+    bool valid = true;
+    for(size_t i = 0; i < count; ++i) {
+        const VertexAttribute& vertex_attribute = layout[i];
+
+        const ShaderVariable* input = NULL;
+        GLint components = 0, locations = 0;
+        bool integer = false;
+        for(const auto& item : attributes) {
+            attribute_shape(item.second.type, &components, &locations, &integer);
+            GLint first = item.second.location;
+            GLint last = first + locations * item.second.size;
+            if((GLint)vertex_attribute.location >= first && (GLint)vertex_attribute.location < last) {
+                input = &item.second;
+                break;
+            }
+        }
+
+        if(!input) {
+            cout << "Warning : vertex attribute at location " << vertex_attribute.location
+                 << " is not used by shader" << endl;
+            continue;
+        }
+        if(integer) {
+            cerr << "Error : shader input " << input->name << " is integer, "
+                 << "glVertexAttribIPointer is required" << endl;
+            valid = false;
+        }
+        // Legal, extra components are fetched and ignored
+        if(vertex_attribute.components > components) {
+            cout << "Warning : vertex attribute at location " << vertex_attribute.location
+                 << " has " << vertex_attribute.components << " components, shader input "
+                 << input->name << " takes " << components << endl;
+        }
+    }
+    return valid;
+}
+
+void ShaderReflection::print() const {
+    for(const auto& item : attributes)
+        cout << "Attribute : " << item.second.name << ", location " << item.second.location
+             << ", type 0x" << hex << item.second.type << dec << endl;
+    for(const auto& item : uniforms)
+        cout << "Uniform   : " << item.second.name << ", location " << item.second.location
+             << ", type 0x" << hex << item.second.type << dec << endl;
+    for(const auto& item : blocks)
+        cout << "Block     : " << item.second.name << ", index " << item.second.index
+             << ", size " << item.second.data_size << endl;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+enum PerfCounter {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,        // L1 data cache read misses
+    PERF_LLC_MISSES,        // Last level cache misses
+    PERF_BRANCH_MISSES,
+    PERF_COUNTERS_COUNT
+};
+
+// Counter values of one measured region, scaled when kernel multiplexed counters
+struct PerfSample {
+    uint64_t values[PERF_COUNTERS_COUNT];
+    bool     valid[PERF_COUNTERS_COUNT];
+};
+
+// Hardware counters of calling thread through perf_event_open (Linux), user
+// space only. Each counter is opened on its own, so missing events (VMs,
+// containers, perf_event_paranoid) leave the rest working. Without any counter
+// start() and stop() do nothing and samples are invalid.
+class PerfCounters {
+    int         fds[PERF_COUNTERS_COUNT];
+    std::string failure;    // Reason first counter failed to open
+public:
+    PerfCounters();
+    PerfCounters(const PerfCounters& rhs) = delete;
+    PerfCounters& operator= (const PerfCounters& rhs) = delete;
+    ~PerfCounters();
+
+    bool available() const;
+    bool available(PerfCounter counter) const {
+        return fds[counter] >= 0;
+    }
+
+    const std::string& error() const {
+        return failure;
+    }
+
+    // Resets and enables counters
+    void start();
+
+    // Disables counters and reads values since start()
+    PerfSample stop();
+};
@@ -1,5 +1,11 @@
 #include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <vector>
 #include <math_utils.h>
+#include <perf_counters.h>
 
 using namespace std;
 
@@ -12,10 +18,102 @@ void print(const Values& values) {
     }
 }
 
+// Keeps benchmark results alive
+static volatile float sink = 0.0f;
+
+// Time and hardware counters of run(), which performs ops operations.
+// Counters missing on this machine are left out of the line.
+template<typename Function>
+static void benchmark(PerfCounters& counters, const char* name, size_t ops, Function run) {
+    run();  // Warm up caches and allocator
+
+    auto start = chrono::steady_clock::now();
+    counters.start();
+    run();
+    const PerfSample sample = counters.stop();
+    const double time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "  " << left << setw(22) << name << right << fixed << setprecision(2)
+         << setw(8) << time * 1e9 / ops << " ns/op";
+    if(sample.valid[PERF_CYCLES] && sample.valid[PERF_INSTRUCTIONS] && sample.values[PERF_CYCLES] > 0)
+        cout << ", IPC " << (double)sample.values[PERF_INSTRUCTIONS] / sample.values[PERF_CYCLES];
+    const struct {
+        PerfCounter counter;
+        const char* name;
+    } misses[] = {
+        { PERF_L1D_MISSES, "L1D" }, { PERF_LLC_MISSES, "LLC" }, { PERF_BRANCH_MISSES, "branch" }
+    };
+    for(const auto& miss : misses)
+        if(sample.valid[miss.counter])
+            cout << ", " << miss.name << " " << setprecision(3) << (double)sample.values[miss.counter] / ops;
+    if(sample.valid[PERF_L1D_MISSES] || sample.valid[PERF_LLC_MISSES] || sample.valid[PERF_BRANCH_MISSES])
+        cout << " misses/op";
+    cout << defaultfloat << endl;
+}
+
+static void run_benchmarks(const Matrix3f& A3, const Matrix3f& B3, const Matrix4f& A4, const Matrix4f& B4) {
+    PerfCounters counters;
+    if(counters.available())
+        cout << "\nHardware counters :" << (counters.available(PERF_CYCLES) ? " cycles" : "")
+             << (counters.available(PERF_INSTRUCTIONS) ? " instructions" : "")
+             << (counters.available(PERF_L1D_MISSES) ? " L1D" : "")
+             << (counters.available(PERF_LLC_MISSES) ? " LLC" : "")
+             << (counters.available(PERF_BRANCH_MISSES) ? " branch" : "") << endl;
+    else
+        cout << "\nHardware counters unavailable (" << counters.error() << "), timings only" << endl;
+
+    // Small matrices stay in L1, cost is arithmetic and result allocation
+    const size_t ops = 1000000;
+    benchmark(counters, "Matrix3f +", ops, [&] {
+        for(size_t i = 0; i < ops; ++i)
+            sink = sink + (A3 + B3).data()[0];
+    });
+    benchmark(counters, "Matrix3f *", ops, [&] {
+        for(size_t i = 0; i < ops; ++i)
+            sink = sink + (A3 * B3).data()[0];
+    });
+    benchmark(counters, "Matrix3f *=", ops, [&] {
+        Matrix3f result(A3);
+        for(size_t i = 0; i < ops; ++i)
+            result *= B3;
+        sink = sink + result.data()[0];
+    });
+    benchmark(counters, "Matrix4f +", ops, [&] {
+        for(size_t i = 0; i < ops; ++i)
+            sink = sink + (A4 + B4).data()[0];
+    });
+    benchmark(counters, "Matrix4f *", ops, [&] {
+        for(size_t i = 0; i < ops; ++i)
+            sink = sink + (A4 * B4).data()[0];
+    });
+    benchmark(counters, "Matrix4f *=", ops, [&] {
+        Matrix4f result(A4);
+        for(size_t i = 0; i < ops; ++i)
+            result *= B4;
+        sink = sink + result.data()[0];
+    });
+
+    // Every matrix owns separate heap block, large set walks memory beyond caches
+    const size_t matrices_count = 1 << 20;
+    vector<unique_ptr<Matrix4f>> matrices(matrices_count);
+    for(unique_ptr<Matrix4f>& matrix : matrices)
+        matrix.reset(new Matrix4f(A4));
+    benchmark(counters, "Matrix4f *= (1M set)", matrices_count, [&] {
+        for(unique_ptr<Matrix4f>& matrix : matrices)
+            *matrix *= B4;
+    });
+}
+
 int main(int argc, char** argv)
 {
     cout << "Application started..." << endl;
 
+    // --bench : matrix kernels timings with hardware counters
+    bool bench = false;
+    for(int i = 1; i < argc; ++i)
+        if(strcmp(argv[i], "--bench") == 0)
+            bench = true;
+
     Values valuesA3 = {
         {1.0f, 1.0f, 1.0f},
         {1.0f, 1.0f, 1.0f},
@@ -73,6 +171,9 @@ int main(int argc, char** argv)
     cout << "\nE4 * B4" << endl;
     print(E4 * B4);
 
+    if(bench)
+        run_benchmarks(A3, B3, E4, B4);
+
     cout << "\nSuccess" << endl;
     return 0;
 }
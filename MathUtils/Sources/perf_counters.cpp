@@ -0,0 +1,99 @@
+#include <perf_counters.h>
+#include <cerrno>
+#include <cstring>    // strerror
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static int open_counter(uint32_t type, uint64_t config) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    // Kernel and hypervisor events need privileges containers usually lack
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+PerfCounters::PerfCounters() {
+    const uint64_t l1d_read_miss = PERF_COUNT_HW_CACHE_L1D |
+        (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    const struct {
+        uint32_t type;
+        uint64_t config;
+    } events[PERF_COUNTERS_COUNT] = {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HW_CACHE, l1d_read_miss },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }
+    };
+
+    for(int i = 0; i < PERF_COUNTERS_COUNT; ++i) {
+        fds[i] = open_counter(events[i].type, events[i].config);
+        if(fds[i] < 0 && failure.empty())
+            failure = strerror(errno);
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for(int fd : fds)
+        if(fd >= 0) close(fd);
+}
+
+void PerfCounters::start() {
+    for(int fd : fds) {
+        if(fd < 0)
+            continue;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+PerfSample PerfCounters::stop() {
+    for(int fd : fds)
+        if(fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+
+    PerfSample sample = {};
+    for(int i = 0; i < PERF_COUNTERS_COUNT; ++i) {
+        // Value, time enabled, time running
+        uint64_t data[3];
+        if(fds[i] < 0 || read(fds[i], data, sizeof(data)) != (ssize_t)sizeof(data) || data[2] == 0)
+            continue;
+        sample.values[i] = data[2] < data[1] ? (uint64_t)((double)data[0] * data[1] / data[2]) : data[0];
+        sample.valid[i] = true;
+    }
+    return sample;
+}
+
+#else
+
+PerfCounters::PerfCounters() : failure("perf_event_open is Linux only") {
+    for(int& fd : fds)
+        fd = -1;
+}
+
+PerfCounters::~PerfCounters() {
+}
+
+void PerfCounters::start() {
+}
+
+PerfSample PerfCounters::stop() {
+    return PerfSample();
+}
+
+#endif
+
+bool PerfCounters::available() const {
+    for(int fd : fds)
+        if(fd >= 0) return true;
+    return false;
+}
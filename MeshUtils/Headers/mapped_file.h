@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+
+// Read-only memory mapped file, pages are loaded by OS on first access
+class MappedFile {
+    const char* bytes;
+    size_t      length;
+public:
+    MappedFile() : bytes(NULL), length(0) {}
+    MappedFile(const MappedFile& rhs) = delete;
+    MappedFile& operator= (const MappedFile& rhs) = delete;
+    ~MappedFile() {
+        close();
+    }
+
+    bool open(const char* path);
+    void close();
+
+    const char* data() const {
+        return bytes;
+    }
+
+    size_t size() const {
+        return length;
+    }
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Indexed triangle mesh, vertex attributes are interleaved floats
+struct Mesh {
+    std::vector<float>    vertices;
+    std::vector<uint32_t> indices;
+    uint32_t              vertex_size = 0;  // Floats per vertex
+
+    size_t vertex_count() const {
+        return vertex_size ? vertices.size() / vertex_size : 0;
+    }
+
+    size_t triangle_count() const {
+        return indices.size() / 3;
+    }
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <mesh.h>
+#include <mapped_file.h>
+
+// Binary mesh container : header, vertex blob, index blob. Blobs start at
+// mesh_file_alignment offsets and have exactly the layout of GPU buffers,
+// so mapped data is passed to glBufferData without copies.
+//
+// | MeshFileHeader | padding | vertices | padding | indices |
+
+static const uint32_t mesh_file_magic = 0x4853454d;     // "MESH"
+static const uint32_t mesh_file_version = 1;
+static const uint32_t mesh_file_alignment = 64;
+static const uint32_t mesh_file_max_attributes = 8;
+
+enum MeshAttributeSemantic {
+    ATTRIBUTE_POSITION = 0,
+    ATTRIBUTE_NORMAL   = 1,
+    ATTRIBUTE_TEXCOORD = 2
+};
+
+// Float attribute inside interleaved vertex
+struct MeshFileAttribute {
+    uint32_t semantic;
+    uint32_t components;
+    uint32_t offset;        // Bytes from vertex start
+    uint32_t reserved;
+};
+
+struct MeshFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vertex_stride;     // Bytes
+    uint32_t index_size;        // 2 or 4 bytes
+    uint64_t vertex_count;
+    uint64_t index_count;
+    uint64_t vertex_offset;
+    uint64_t vertex_bytes;
+    uint64_t index_offset;
+    uint64_t index_bytes;
+    float    bounds_min[3];
+    float    bounds_max[3];
+    uint32_t attributes_count;
+    uint32_t reserved;
+    MeshFileAttribute attributes[mesh_file_max_attributes];
+};
+
+static_assert(sizeof(MeshFileHeader) == 224, "MeshFileHeader layout must not depend on compiler");
+
+// Writes indexed mesh, indices are stored as 16 bit when vertex count allows.
+// Vertex of 3 floats is position, of 8 floats position, normal and texture coords.
+bool write_mesh_file(const char* path, const Mesh& mesh);
+
+// Memory mapped mesh file, header and blobs point into mapping
+class MeshFile {
+    MappedFile            file;
+    const MeshFileHeader* mesh_header;
+public:
+    MeshFile() : mesh_header(NULL) {}
+
+    // Validates header and blob ranges
+    bool open(const char* path);
+    void close();
+
+    const MeshFileHeader& header() const {
+        return *mesh_header;
+    }
+
+    const void* vertices() const {
+        return file.data() + mesh_header->vertex_offset;
+    }
+
+    const void* indices() const {
+        return file.data() + mesh_header->index_offset;
+    }
+};
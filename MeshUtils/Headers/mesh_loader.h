@@ -0,0 +1,21 @@
+#pragma once
+
+#include <mesh.h>
+
+// Loaded meshes use 8 floats per vertex : position, normal, texture coords,
+// missing attributes are zero
+static const uint32_t loaded_vertex_size = 8;
+
+// File is memory mapped and split into line aligned chunks parsed in parallel,
+// threads = 0 uses all hardware threads. Polygons are triangulated as fans.
+
+// Wavefront OBJ : v, vt, vn and f records, negative (relative) indices supported,
+// unique v/vt/vn combinations become vertices
+bool load_obj(const char* path, Mesh& mesh, unsigned int threads = 0);
+
+// PLY : ascii and binary_little_endian, vertex element (x y z, nx ny nz, u v / s t)
+// and face element with vertex_indices list
+bool load_ply(const char* path, Mesh& mesh, unsigned int threads = 0);
+
+// Chooses loader by file extension
+bool load_mesh(const char* path, Mesh& mesh, unsigned int threads = 0);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <mesh.h>
+
+// Builds indexed mesh from triangle soup, identical vertices are merged
+// through hash table (bitwise comparison of all attributes)
+void build_indexed_mesh(const float* vertices, size_t vertex_count, uint32_t vertex_size, Mesh& mesh);
+
+// Reorders triangles for post-transform cache locality (Tipsify, Sander et al. 2007)
+void optimize_vertex_cache(Mesh& mesh, uint32_t cache_size = 16);
+
+// Reorders triangle clusters so outer surfaces are drawn first and hide
+// inner ones, clusters are split at vertex cache restarts so cache
+// efficiency stays nearly the same. Position must be first 3 floats of vertex.
+void optimize_overdraw(Mesh& mesh, uint32_t cache_size = 16);
+
+// Reorders vertices by first use in index buffer for fetch locality
+void optimize_vertex_fetch(Mesh& mesh);
+
+struct VertexCacheStatistics {
+    float acmr;         // Average cache miss ratio : transformed vertices per triangle
+    float atvr;         // Average transform to vertex ratio : transformed / unique vertices
+};
+
+// FIFO post-transform cache simulation
+VertexCacheStatistics analyze_vertex_cache(const Mesh& mesh, uint32_t cache_size = 16);
+
+// Fetched bytes / vertex buffer size, direct mapped cache simulation
+// with 64 byte lines and 256 lines
+float analyze_vertex_fetch(const Mesh& mesh);
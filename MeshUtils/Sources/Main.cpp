@@ -0,0 +1,309 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+#include <mesh_optimizer.h>
+#include <mesh_loader.h>
+#include <mesh_file.h>
+
+using namespace std;
+
+// Test meshes : vertex is position, normal and texture coords
+static const uint32_t vertex_size = 8;
+static const float pi = 3.14159265f;
+
+typedef void (*SurfaceFunction)(float u, float v, float* vertex);
+
+static void sphere(float u, float v, float* vertex) {
+    const float theta = u * 2.0f * pi, phi = v * pi;
+    const float normal[3] = { sin(phi) * cos(theta), cos(phi), sin(phi) * sin(theta) };
+    // Unit sphere : position equals normal
+    const float result[vertex_size] = { normal[0], normal[1], normal[2], normal[0], normal[1], normal[2], u, v };
+    copy(result, result + vertex_size, vertex);
+}
+
+static void torus(float u, float v, float* vertex) {
+    const float theta = u * 2.0f * pi, phi = v * 2.0f * pi;
+    const float major = 1.0f, minor = 0.3f;
+    const float normal[3] = { cos(phi) * cos(theta), sin(phi), cos(phi) * sin(theta) };
+    const float result[vertex_size] = {
+        (major + minor * cos(phi)) * cos(theta), minor * sin(phi), (major + minor * cos(phi)) * sin(theta),
+        normal[0], normal[1], normal[2], u, v
+    };
+    copy(result, result + vertex_size, vertex);
+}
+
+static void grid(float u, float v, float* vertex) {
+    const float result[vertex_size] = { u * 2.0f - 1.0f, 0.0f, v * 2.0f - 1.0f, 0.0f, 1.0f, 0.0f, u, v };
+    copy(result, result + vertex_size, vertex);
+}
+
+// Parametric surface as triangle soup in random triangle order, like
+// exporters without indexing produce
+static vector<float> make_soup(SurfaceFunction surface, int columns, int rows) {
+    vector<float> soup;
+    soup.reserve((size_t)columns * rows * 6 * vertex_size);
+    float vertex[vertex_size];
+    for(int row = 0; row < rows; ++row) {
+        for(int col = 0; col < columns; ++col) {
+            const int corners[6][2] = {
+                { col, row }, { col + 1, row }, { col + 1, row + 1 },
+                { col, row }, { col + 1, row + 1 }, { col, row + 1 }
+            };
+            for(int i = 0; i < 6; ++i) {
+                surface((float)corners[i][0] / columns, (float)corners[i][1] / rows, vertex);
+                soup.insert(soup.end(), vertex, vertex + vertex_size);
+            }
+        }
+    }
+
+    const size_t triangle_floats = 3 * vertex_size;
+    const size_t triangles = soup.size() / triangle_floats;
+    mt19937 random(42);
+    for(size_t i = triangles - 1; i > 0; --i) {
+        size_t j = random() % (i + 1);
+        swap_ranges(soup.begin() + i * triangle_floats, soup.begin() + (i + 1) * triangle_floats,
+                    soup.begin() + j * triangle_floats);
+    }
+    return soup;
+}
+
+static void print(const char* step, const Mesh& mesh, double time) {
+    VertexCacheStatistics statistics = analyze_vertex_cache(mesh);
+    cout << "  " << step
+         << " : vertices " << mesh.vertex_count()
+         << ", ACMR " << statistics.acmr
+         << ", ATVR " << statistics.atvr
+         << ", overfetch " << analyze_vertex_fetch(mesh)
+         << ", time " << time * 1000.0 << " ms" << endl;
+}
+
+template<typename Function>
+static double measure(Function function) {
+    auto start = chrono::steady_clock::now();
+    function();
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static void optimize(const char* name, SurfaceFunction surface, int columns, int rows) {
+    vector<float> soup = make_soup(surface, columns, rows);
+    const size_t soup_vertices = soup.size() / vertex_size;
+    cout << "\n" << name << " : " << soup_vertices / 3 << " triangles, "
+         << soup_vertices << " soup vertices" << endl;
+
+    Mesh mesh;
+    double time = measure([&] { build_indexed_mesh(soup.data(), soup_vertices, vertex_size, mesh); });
+    print("indexed      ", mesh, time);
+
+    time = measure([&] { optimize_vertex_cache(mesh); });
+    print("vertex cache ", mesh, time);
+
+    time = measure([&] { optimize_overdraw(mesh); });
+    print("overdraw     ", mesh, time);
+
+    time = measure([&] { optimize_vertex_fetch(mesh); });
+    print("vertex fetch ", mesh, time);
+}
+
+// Floats are printed with 9 digits so they are read back exactly
+static bool write_obj(const char* path, const Mesh& mesh) {
+    FILE* file = fopen(path, "w");
+    if(!file)
+        return false;
+    fprintf(file, "# MeshUtils test mesh\n");
+    for(size_t v = 0; v < mesh.vertex_count(); ++v) {
+        const float* vertex = &mesh.vertices[v * mesh.vertex_size];
+        fprintf(file, "v %.9g %.9g %.9g\nvn %.9g %.9g %.9g\nvt %.9g %.9g\n",
+                vertex[0], vertex[1], vertex[2], vertex[3], vertex[4], vertex[5], vertex[6], vertex[7]);
+    }
+    // Relative indices for every second face to cover both forms
+    const long count = (long)mesh.vertex_count();
+    for(size_t t = 0; t < mesh.triangle_count(); ++t) {
+        fprintf(file, "f");
+        for(int c = 0; c < 3; ++c) {
+            long index = mesh.indices[t * 3 + c] + 1;
+            if(t % 2)
+                index -= count + 1;
+            fprintf(file, " %ld/%ld/%ld", index, index, index);
+        }
+        fprintf(file, "\n");
+    }
+    return fclose(file) == 0;
+}
+
+static bool write_ply(const char* path, const Mesh& mesh, bool binary) {
+    FILE* file = fopen(path, binary ? "wb" : "w");
+    if(!file)
+        return false;
+    fprintf(file, "ply\nformat %s 1.0\n", binary ? "binary_little_endian" : "ascii");
+    fprintf(file, "element vertex %zu\n", mesh.vertex_count());
+    for(const char* name : { "x", "y", "z", "nx", "ny", "nz", "u", "v" })
+        fprintf(file, "property float %s\n", name);
+    fprintf(file, "element face %zu\nproperty list uchar int vertex_indices\nend_header\n", mesh.triangle_count());
+
+    if(binary) {
+        fwrite(mesh.vertices.data(), sizeof(float), mesh.vertices.size(), file);
+        for(size_t t = 0; t < mesh.triangle_count(); ++t) {
+            const unsigned char corners = 3;
+            fwrite(&corners, 1, 1, file);
+            fwrite(&mesh.indices[t * 3], sizeof(uint32_t), 3, file);
+        }
+    } else {
+        for(size_t v = 0; v < mesh.vertex_count(); ++v) {
+            const float* vertex = &mesh.vertices[v * mesh.vertex_size];
+            fprintf(file, "%.9g %.9g %.9g %.9g %.9g %.9g %.9g %.9g\n",
+                    vertex[0], vertex[1], vertex[2], vertex[3], vertex[4], vertex[5], vertex[6], vertex[7]);
+        }
+        for(size_t t = 0; t < mesh.triangle_count(); ++t)
+            fprintf(file, "3 %u %u %u\n", mesh.indices[t * 3], mesh.indices[t * 3 + 1], mesh.indices[t * 3 + 2]);
+    }
+    return fclose(file) == 0;
+}
+
+// Same triangles with same vertex values, vertex order may differ
+static bool same_triangles(const Mesh& lhs, const Mesh& rhs) {
+    if(lhs.indices.size() != rhs.indices.size() || lhs.vertex_size != rhs.vertex_size)
+        return false;
+    const size_t vertex_bytes = sizeof(float) * lhs.vertex_size;
+    for(size_t i = 0; i < lhs.indices.size(); ++i)
+        if(memcmp(&lhs.vertices[(size_t)lhs.indices[i] * lhs.vertex_size],
+                  &rhs.vertices[(size_t)rhs.indices[i] * rhs.vertex_size], vertex_bytes) != 0)
+            return false;
+    return true;
+}
+
+static double load(const char* path, Mesh& mesh, unsigned int threads) {
+    error_code error;
+    const double megabytes = filesystem::file_size(path, error) / (1024.0 * 1024.0);
+    bool result = false;
+    double time = measure([&] { result = load_mesh(path, mesh, threads); });
+    if(!result)
+        return -1.0;
+    cout << "  " << path << " : " << megabytes << " MB, "
+         << mesh.vertex_count() << " vertices, " << mesh.triangle_count() << " triangles, "
+         << threads << " threads, " << time * 1000.0 << " ms, " << megabytes / time << " MB/s" << endl;
+    return time;
+}
+
+// Mesh file is ready when it is mapped and its pages are resident, blobs are
+// read once the way glBufferData would read them
+static bool benchmark_mesh_file(const Mesh& source, const string& path, double obj_time) {
+    if(!write_mesh_file(path.c_str(), source))
+        return false;
+
+    MeshFile file;
+    uint64_t checksum = 0;
+    double time = measure([&] {
+        if(!file.open(path.c_str()))
+            return;
+        const MeshFileHeader& header = file.header();
+        const uint64_t* words = (const uint64_t*)file.vertices();
+        for(size_t i = 0; i < header.vertex_bytes / sizeof(uint64_t); ++i)
+            checksum += words[i];
+        words = (const uint64_t*)file.indices();
+        for(size_t i = 0; i < header.index_bytes / sizeof(uint64_t); ++i)
+            checksum += words[i];
+    });
+
+    bool result = checksum != 0 && file.header().vertex_bytes == source.vertices.size() * sizeof(float) &&
+        file.header().index_size == sizeof(uint32_t) && file.header().index_count == source.indices.size() &&
+        memcmp(file.vertices(), source.vertices.data(), file.header().vertex_bytes) == 0 &&
+        memcmp(file.indices(), source.indices.data(), file.header().index_bytes) == 0;
+    if(!result)
+        cerr << "Error : mesh file differs from source " << path << endl;
+
+    error_code error;
+    const double megabytes = filesystem::file_size(path, error) / (1024.0 * 1024.0);
+    cout << "  " << path << " : " << megabytes << " MB, mapped in " << time * 1000.0 << " ms, "
+         << megabytes / time << " MB/s, " << obj_time / time << "x faster than OBJ" << endl;
+
+    file.close();
+    filesystem::remove(path);
+    return result;
+}
+
+static bool benchmark_loaders() {
+    vector<float> soup = make_soup(sphere, 1024, 512);
+    Mesh source;
+    build_indexed_mesh(soup.data(), soup.size() / vertex_size, vertex_size, source);
+
+    const filesystem::path directory = filesystem::temp_directory_path();
+    const string obj = (directory / "mesh_utils_test.obj").string();
+    const string ply_ascii = (directory / "mesh_utils_test_ascii.ply").string();
+    const string ply_binary = (directory / "mesh_utils_test_binary.ply").string();
+    if(!write_obj(obj.c_str(), source) || !write_ply(ply_ascii.c_str(), source, false) ||
+       !write_ply(ply_binary.c_str(), source, true)) {
+        cerr << "Error : unable to write test meshes to " << directory << endl;
+        return false;
+    }
+
+    unsigned int threads = thread::hardware_concurrency();
+    if(threads == 0)
+        threads = 1;
+
+    cout << "\nLoading " << source.triangle_count() << " triangles" << endl;
+    bool result = true;
+    double obj_time = 0.0;
+    for(const string& path : { obj, ply_ascii, ply_binary }) {
+        for(unsigned int count : { 1u, threads }) {
+            Mesh mesh;
+            double time = load(path.c_str(), mesh, count);
+            if(time < 0.0 || !same_triangles(source, mesh)) {
+                cerr << "Error : loaded mesh differs from source " << path << endl;
+                result = false;
+            }
+            if(path == obj)
+                obj_time = time;
+        }
+        filesystem::remove(path);
+    }
+
+    return benchmark_mesh_file(source, (directory / "mesh_utils_test.mesh").string(), obj_time) && result;
+}
+
+int main(int argc, char** argv)
+{
+    cout << "Application started..." << endl;
+
+    // --load <file> [--threads N] : load and optimize mesh file
+    const char* path = NULL;
+    unsigned int threads = 0;
+    for(int i = 1; i < argc; ++i) {
+        if(strcmp(argv[i], "--load") == 0 && i + 1 < argc)
+            path = argv[++i];
+        else if(strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threads = (unsigned int)atoi(argv[++i]);
+    }
+
+    if(path) {
+        Mesh mesh;
+        if(load(path, mesh, threads > 0 ? threads : max(thread::hardware_concurrency(), 1u)) < 0.0)
+            return 1;
+        cout << "Cache : FIFO, 16 vertices" << endl;
+        print("loaded       ", mesh, 0.0);
+        optimize_vertex_cache(mesh);
+        optimize_overdraw(mesh);
+        optimize_vertex_fetch(mesh);
+        print("optimized    ", mesh, 0.0);
+        cout << "\nSuccess" << endl;
+        return 0;
+    }
+
+    cout << "Cache : FIFO, 16 vertices" << endl;
+
+    optimize("Grid",   grid,   256, 256);
+    optimize("Sphere", sphere, 256, 128);
+    optimize("Torus",  torus,  256, 64);
+
+    if(!benchmark_loaders())
+        return 1;
+
+    cout << "\nSuccess" << endl;
+    return 0;
+}
@@ -0,0 +1,45 @@
+#include <mapped_file.h>
+#include <fcntl.h>      // open
+#include <sys/mman.h>   // mmap
+#include <sys/stat.h>   // fstat
+#include <unistd.h>     // close
+#include <iostream>     // cerr
+
+bool MappedFile::open(const char* path) {
+    close();
+
+    int fd = ::open(path, O_RDONLY);
+    if(fd < 0) {
+        std::cerr << "Error : unable to open file " << path << std::endl;
+        return false;
+    }
+
+    struct stat info;
+    if(fstat(fd, &info) != 0 || info.st_size == 0) {
+        std::cerr << "Error : unable to get size or empty file " << path << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    // Mapping stays valid after descriptor is closed
+    void* mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(mapping == MAP_FAILED) {
+        std::cerr << "Error : unable to map file " << path << std::endl;
+        return false;
+    }
+
+    // Whole file is parsed front to back
+    madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+
+    bytes = (const char*)mapping;
+    length = info.st_size;
+    return true;
+}
+
+void MappedFile::close() {
+    if(bytes)
+        munmap((void*)bytes, length);
+    bytes = NULL;
+    length = 0;
+}
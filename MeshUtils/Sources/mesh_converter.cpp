@@ -0,0 +1,46 @@
+#include <iostream>
+#include <cstring>
+#include <mesh_loader.h>
+#include <mesh_optimizer.h>
+#include <mesh_file.h>
+
+using namespace std;
+
+// Converts OBJ / PLY into binary mesh file, mesh is optimized for
+// vertex cache, overdraw and vertex fetch unless --no-optimize is given
+int main(int argc, char** argv)
+{
+    const char* input = NULL;
+    const char* output = NULL;
+    bool optimize = true;
+    for(int i = 1; i < argc; ++i) {
+        if(strcmp(argv[i], "--no-optimize") == 0)
+            optimize = false;
+        else if(!input)
+            input = argv[i];
+        else if(!output)
+            output = argv[i];
+    }
+
+    if(!input || !output) {
+        cerr << "Usage : " << argv[0] << " <input.obj|input.ply> <output.mesh> [--no-optimize]" << endl;
+        return 1;
+    }
+
+    Mesh mesh;
+    if(!load_mesh(input, mesh))
+        return 1;
+
+    if(optimize) {
+        optimize_vertex_cache(mesh);
+        optimize_overdraw(mesh);
+        optimize_vertex_fetch(mesh);
+    }
+
+    if(!write_mesh_file(output, mesh))
+        return 1;
+
+    cout << input << " -> " << output << " : " << mesh.vertex_count() << " vertices, "
+         << mesh.triangle_count() << " triangles" << endl;
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include <mesh_file.h>
+#include <algorithm>  // min, max
+#include <cfloat>     // FLT_MAX
+#include <cstdio>     // fopen, fwrite
+#include <cstring>    // memset
+#include <iostream>   // cerr
+
+static uint64_t align(uint64_t offset) {
+    return (offset + mesh_file_alignment - 1) / mesh_file_alignment * mesh_file_alignment;
+}
+
+static bool write_padding(FILE* file, uint64_t from, uint64_t to) {
+    static const char zeros[mesh_file_alignment] = {};
+    return to == from || fwrite(zeros, 1, to - from, file) == to - from;
+}
+
+bool write_mesh_file(const char* path, const Mesh& mesh) {
+    MeshFileHeader header;
+    memset(&header, 0, sizeof(header));
+
+    const MeshFileAttribute layout[] = {
+        { ATTRIBUTE_POSITION, 3, 0,  0 },
+        { ATTRIBUTE_NORMAL,   3, 12, 0 },
+        { ATTRIBUTE_TEXCOORD, 2, 24, 0 }
+    };
+    if(mesh.vertex_size == 3)
+        header.attributes_count = 1;
+    else if(mesh.vertex_size == 8)
+        header.attributes_count = 3;
+    else {
+        std::cerr << "Error : unsupported vertex size " << mesh.vertex_size << std::endl;
+        return false;
+    }
+    memcpy(header.attributes, layout, sizeof(MeshFileAttribute) * header.attributes_count);
+
+    const size_t vertex_count = mesh.vertex_count();
+    header.magic = mesh_file_magic;
+    header.version = mesh_file_version;
+    header.vertex_stride = mesh.vertex_size * sizeof(float);
+    header.index_size = vertex_count <= 0x10000 ? sizeof(uint16_t) : sizeof(uint32_t);
+    header.vertex_count = vertex_count;
+    header.index_count = mesh.indices.size();
+    header.vertex_offset = align(sizeof(header));
+    header.vertex_bytes = (uint64_t)vertex_count * header.vertex_stride;
+    header.index_offset = align(header.vertex_offset + header.vertex_bytes);
+    header.index_bytes = header.index_count * header.index_size;
+
+    for(int c = 0; c < 3; ++c) {
+        header.bounds_min[c] = vertex_count ? FLT_MAX : 0.0f;
+        header.bounds_max[c] = vertex_count ? -FLT_MAX : 0.0f;
+    }
+    for(size_t v = 0; v < vertex_count; ++v) {
+        const float* position = &mesh.vertices[v * mesh.vertex_size];
+        for(int c = 0; c < 3; ++c) {
+            header.bounds_min[c] = std::min(header.bounds_min[c], position[c]);
+            header.bounds_max[c] = std::max(header.bounds_max[c], position[c]);
+        }
+    }
+
+    FILE* file = fopen(path, "wb");
+    if(!file) {
+        std::cerr << "Error : unable to create file " << path << std::endl;
+        return false;
+    }
+
+    bool result = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        write_padding(file, sizeof(header), header.vertex_offset) &&
+        fwrite(mesh.vertices.data(), 1, header.vertex_bytes, file) == header.vertex_bytes &&
+        write_padding(file, header.vertex_offset + header.vertex_bytes, header.index_offset);
+
+    if(result && header.index_size == sizeof(uint16_t)) {
+        std::vector<uint16_t> indices(mesh.indices.begin(), mesh.indices.end());
+        result = fwrite(indices.data(), 1, header.index_bytes, file) == header.index_bytes;
+    } else if(result) {
+        result = fwrite(mesh.indices.data(), 1, header.index_bytes, file) == header.index_bytes;
+    }
+
+    if(fclose(file) != 0 || !result) {
+        std::cerr << "Error : unable to write file " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Every float attribute must lie inside one vertex
+static bool attributes_fit(const MeshFileHeader* header) {
+    for(uint32_t i = 0; i < header->attributes_count; ++i) {
+        const MeshFileAttribute& attribute = header->attributes[i];
+        if(attribute.components == 0 || attribute.components > 4 ||
+           (uint64_t)attribute.offset + attribute.components * sizeof(float) > header->vertex_stride)
+            return false;
+    }
+    return true;
+}
+
+bool MeshFile::open(const char* path) {
+    close();
+    if(!file.open(path))
+        return false;
+
+    const MeshFileHeader* header = (const MeshFileHeader*)file.data();
+    const uint64_t size = file.size();
+    if(size < sizeof(MeshFileHeader) || header->magic != mesh_file_magic) {
+        std::cerr << "Error : not a mesh file " << path << std::endl;
+        file.close();
+        return false;
+    }
+    if(header->version != mesh_file_version) {
+        std::cerr << "Error : unsupported mesh file version " << header->version << " in " << path << std::endl;
+        file.close();
+        return false;
+    }
+
+    // Counts are checked against file size first, so byte sizes can't overflow
+    const bool valid =
+        (header->index_size == 2 || header->index_size == 4) && header->vertex_stride != 0 &&
+        header->vertex_count <= size / header->vertex_stride && header->index_count <= size / header->index_size &&
+        header->attributes_count <= mesh_file_max_attributes && attributes_fit(header) &&
+        header->vertex_offset % mesh_file_alignment == 0 && header->index_offset % mesh_file_alignment == 0 &&
+        header->vertex_bytes == header->vertex_count * header->vertex_stride &&
+        header->index_bytes == header->index_count * header->index_size &&
+        header->vertex_offset <= size && header->vertex_bytes <= size - header->vertex_offset &&
+        header->index_offset <= size && header->index_bytes <= size - header->index_offset;
+    if(!valid) {
+        std::cerr << "Error : corrupted mesh file " << path << std::endl;
+        file.close();
+        return false;
+    }
+
+    mesh_header = header;
+    return true;
+}
+
+void MeshFile::close() {
+    file.close();
+    mesh_header = NULL;
+}
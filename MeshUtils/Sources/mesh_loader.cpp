@@ -0,0 +1,708 @@
+#include <mesh_loader.h>
+#include <mapped_file.h>
+#include <algorithm>  // max
+#include <atomic>
+#include <charconv>   // from_chars
+#include <cstdlib>    // strtof
+#include <cstring>    // memcpy, memchr, strcmp
+#include <iostream>   // cerr
+#include <sstream>    // istringstream
+#include <string>
+#include <thread>
+
+static unsigned int thread_count(unsigned int threads) {
+    if(threads > 0)
+        return threads;
+    unsigned int hardware = std::thread::hardware_concurrency();
+    return hardware > 0 ? hardware : 1;
+}
+
+// Runs function(index) for every index in [0, count) on worker threads
+template<typename Function>
+static void parallel_for(size_t count, unsigned int threads, Function function) {
+    if(threads <= 1 || count <= 1) {
+        for(size_t i = 0; i < count; ++i)
+            function(i);
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    for(unsigned int t = 0; t < threads && t < count; ++t) {
+        workers.emplace_back([&] {
+            for(size_t i = next++; i < count; i = next++)
+                function(i);
+        });
+    }
+    for(std::thread& worker : workers)
+        worker.join();
+}
+
+struct TextChunk {
+    const char* begin;
+    const char* end;
+};
+
+// Chunks end right after line break, so no line is split between chunks
+static std::vector<TextChunk> split_lines(const char* begin, const char* end, size_t chunks) {
+    std::vector<TextChunk> result;
+    const size_t size = end - begin;
+    const char* start = begin;
+    for(size_t i = 1; i < chunks; ++i) {
+        const char* split = begin + size * i / chunks;
+        if(split < start)
+            split = start;
+        const char* line_end = (const char*)memchr(split, '\n', end - split);
+        split = line_end ? line_end + 1 : end;
+        result.push_back({ start, split });
+        start = split;
+    }
+    result.push_back({ start, end });
+    return result;
+}
+
+static inline bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline const char* skip_spaces(const char* p, const char* end) {
+    while(p < end && is_space(*p))
+        ++p;
+    return p;
+}
+
+static inline const char* next_line(const char* p, const char* end) {
+    const char* line_end = (const char*)memchr(p, '\n', end - p);
+    return line_end ? line_end + 1 : end;
+}
+
+// Returns NULL on error, otherwise position after number
+static inline const char* parse_float(const char* p, const char* end, float& value) {
+    p = skip_spaces(p, end);
+    if(p < end && *p == '+')
+        ++p;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    std::from_chars_result result = std::from_chars(p, end, value);
+    return result.ec == std::errc() ? result.ptr : NULL;
+#else
+    // Floating point from_chars is missing, strtof needs terminated string
+    char buffer[64];
+    size_t length = 0;
+    while(p + length < end && length < sizeof(buffer) - 1 && !is_space(p[length]) && p[length] != '\n')
+        buffer[length] = p[length], ++length;
+    buffer[length] = 0;
+    char* stop = NULL;
+    value = strtof(buffer, &stop);
+    return stop != buffer ? p + (stop - buffer) : NULL;
+#endif
+}
+
+template<typename Integer>
+static inline const char* parse_integer(const char* p, const char* end, Integer& value) {
+    p = skip_spaces(p, end);
+    if(p < end && *p == '+')
+        ++p;
+    std::from_chars_result result = std::from_chars(p, end, value);
+    return result.ec == std::errc() ? result.ptr : NULL;
+}
+
+// OBJ
+
+static const int32_t missing_index = INT32_MIN;
+
+// Zero based indices, relative mask marks values counted from chunk start
+struct ObjCorner {
+    int32_t v, vt, vn;
+    uint8_t relative;
+};
+
+struct ObjChunk {
+    TextChunk              text;
+    std::vector<float>     positions, texcoords, normals;
+    std::vector<ObjCorner> corners;     // 3 per triangle
+    size_t position_offset, texcoord_offset, normal_offset, corner_offset;
+    bool   valid;
+};
+
+// OBJ index : positive is 1-based absolute, negative is relative to current count
+static inline const char* parse_obj_index(const char* p, const char* end, size_t count,
+                                          int32_t& index, uint8_t& relative, uint8_t relative_bit) {
+    int32_t raw = 0;
+    p = parse_integer(p, end, raw);
+    if(!p || raw == 0)
+        return NULL;
+    if(raw > 0) {
+        index = raw - 1;
+    } else {
+        index = (int32_t)count + raw;
+        relative |= relative_bit;
+    }
+    return p;
+}
+
+static bool parse_obj_chunk(ObjChunk& chunk) {
+    const char* end = chunk.text.end;
+    ObjCorner polygon_first = {}, polygon_last = {};
+
+    for(const char* p = chunk.text.begin; p < end; p = next_line(p, end)) {
+        p = skip_spaces(p, end);
+        if(end - p < 2)
+            continue;
+
+        if(p[0] == 'v' && is_space(p[1])) {
+            float xyz[3];
+            p = parse_float(p + 1, end, xyz[0]);
+            if(p) p = parse_float(p, end, xyz[1]);
+            if(p) p = parse_float(p, end, xyz[2]);
+            if(!p) return false;
+            chunk.positions.insert(chunk.positions.end(), xyz, xyz + 3);
+        } else if(p[0] == 'v' && p[1] == 't') {
+            float uv[2] = { 0.0f, 0.0f };
+            p = parse_float(p + 2, end, uv[0]);
+            if(!p) return false;
+            // Second coordinate is optional
+            const char* v = parse_float(p, end, uv[1]);
+            p = v ? v : p;
+            chunk.texcoords.insert(chunk.texcoords.end(), uv, uv + 2);
+        } else if(p[0] == 'v' && p[1] == 'n') {
+            float xyz[3];
+            p = parse_float(p + 2, end, xyz[0]);
+            if(p) p = parse_float(p, end, xyz[1]);
+            if(p) p = parse_float(p, end, xyz[2]);
+            if(!p) return false;
+            chunk.normals.insert(chunk.normals.end(), xyz, xyz + 3);
+        } else if(p[0] == 'f' && is_space(p[1])) {
+            const size_t positions = chunk.positions.size() / 3;
+            const size_t texcoords = chunk.texcoords.size() / 2;
+            const size_t normals = chunk.normals.size() / 3;
+            int corners = 0;
+            ++p;
+            for(;;) {
+                p = skip_spaces(p, end);
+                if(p >= end || *p == '\n' || *p == '#')
+                    break;
+
+                // v, v/vt, v//vn, v/vt/vn
+                ObjCorner corner = { missing_index, missing_index, missing_index, 0 };
+                p = parse_obj_index(p, end, positions, corner.v, corner.relative, 1);
+                if(!p) return false;
+                if(p < end && *p == '/') {
+                    ++p;
+                    if(p < end && *p != '/') {
+                        p = parse_obj_index(p, end, texcoords, corner.vt, corner.relative, 2);
+                        if(!p) return false;
+                    }
+                    if(p < end && *p == '/') {
+                        p = parse_obj_index(p + 1, end, normals, corner.vn, corner.relative, 4);
+                        if(!p) return false;
+                    }
+                }
+
+                if(corners == 0) {
+                    polygon_first = corner;
+                } else if(corners >= 2) {
+                    chunk.corners.push_back(polygon_first);
+                    chunk.corners.push_back(polygon_last);
+                    chunk.corners.push_back(corner);
+                }
+                polygon_last = corner;
+                ++corners;
+            }
+        }
+    }
+    return true;
+}
+
+static inline bool resolve_obj_index(int32_t& index, bool relative, size_t offset, size_t count) {
+    if(index == missing_index)
+        return true;
+    int64_t value = (int64_t)index + (relative ? (int64_t)offset : 0);
+    if(value < 0 || value >= (int64_t)count)
+        return false;
+    index = (int32_t)value;
+    return true;
+}
+
+static uint64_t hash_corner(const ObjCorner& corner) {
+    uint64_t hash = (uint32_t)corner.v * 0x9e3779b97f4a7c15ull;
+    hash ^= (uint32_t)corner.vt * 0xc2b2ae3d27d4eb4full + (hash << 6) + (hash >> 2);
+    hash ^= (uint32_t)corner.vn * 0x165667b19e3779f9ull + (hash << 6) + (hash >> 2);
+    return hash ^ (hash >> 29);
+}
+
+bool load_obj(const char* path, Mesh& mesh, unsigned int threads) {
+    MappedFile file;
+    if(!file.open(path))
+        return false;
+
+    threads = thread_count(threads);
+    const size_t min_chunk_size = 1 << 20;
+    size_t chunks_count = file.size() / min_chunk_size + 1;
+    if(chunks_count > threads * 4)
+        chunks_count = threads * 4;
+
+    std::vector<TextChunk> text = split_lines(file.data(), file.data() + file.size(), chunks_count);
+    std::vector<ObjChunk> chunks(text.size());
+    parallel_for(chunks.size(), threads, [&](size_t i) {
+        chunks[i].text = text[i];
+        chunks[i].valid = parse_obj_chunk(chunks[i]);
+    });
+
+    // Chunk data positions in merged arrays
+    size_t positions = 0, texcoords = 0, normals = 0, corners = 0;
+    for(ObjChunk& chunk : chunks) {
+        if(!chunk.valid) {
+            std::cerr << "Error : failed to parse " << path << std::endl;
+            return false;
+        }
+        chunk.position_offset = positions;
+        chunk.texcoord_offset = texcoords;
+        chunk.normal_offset = normals;
+        chunk.corner_offset = corners;
+        positions += chunk.positions.size() / 3;
+        texcoords += chunk.texcoords.size() / 2;
+        normals += chunk.normals.size() / 3;
+        corners += chunk.corners.size();
+    }
+
+    std::vector<float> all_positions(positions * 3), all_texcoords(texcoords * 2), all_normals(normals * 3);
+    std::vector<ObjCorner> all_corners(corners);
+    parallel_for(chunks.size(), threads, [&](size_t i) {
+        ObjChunk& chunk = chunks[i];
+        std::copy(chunk.positions.begin(), chunk.positions.end(), all_positions.begin() + chunk.position_offset * 3);
+        std::copy(chunk.texcoords.begin(), chunk.texcoords.end(), all_texcoords.begin() + chunk.texcoord_offset * 2);
+        std::copy(chunk.normals.begin(), chunk.normals.end(), all_normals.begin() + chunk.normal_offset * 3);
+
+        ObjCorner* output = all_corners.data() + chunk.corner_offset;
+        for(size_t c = 0; c < chunk.corners.size(); ++c) {
+            ObjCorner corner = chunk.corners[c];
+            chunk.valid = chunk.valid &&
+                resolve_obj_index(corner.v,  corner.relative & 1, chunk.position_offset, positions) &&
+                resolve_obj_index(corner.vt, corner.relative & 2, chunk.texcoord_offset, texcoords) &&
+                resolve_obj_index(corner.vn, corner.relative & 4, chunk.normal_offset, normals) &&
+                corner.v != missing_index;
+            corner.relative = 0;
+            output[c] = corner;
+        }
+
+        std::vector<float>().swap(chunk.positions);
+        std::vector<float>().swap(chunk.texcoords);
+        std::vector<float>().swap(chunk.normals);
+        std::vector<ObjCorner>().swap(chunk.corners);
+    });
+
+    for(const ObjChunk& chunk : chunks) {
+        if(!chunk.valid) {
+            std::cerr << "Error : invalid face index in " << path << std::endl;
+            return false;
+        }
+    }
+
+    // Unique v/vt/vn combinations become vertices
+    size_t table_size = 1;
+    while(table_size < corners * 2)
+        table_size <<= 1;
+    const size_t mask = table_size - 1;
+    std::vector<uint32_t> table(table_size, UINT32_MAX);
+    std::vector<ObjCorner> unique;
+    unique.reserve(positions);
+
+    mesh.vertex_size = loaded_vertex_size;
+    mesh.indices.resize(corners);
+    for(size_t c = 0; c < corners; ++c) {
+        const ObjCorner& corner = all_corners[c];
+        size_t slot = hash_corner(corner) & mask;
+        while(table[slot] != UINT32_MAX) {
+            const ObjCorner& other = unique[table[slot]];
+            if(other.v == corner.v && other.vt == corner.vt && other.vn == corner.vn)
+                break;
+            slot = (slot + 1) & mask;
+        }
+        if(table[slot] == UINT32_MAX) {
+            table[slot] = (uint32_t)unique.size();
+            unique.push_back(corner);
+        }
+        mesh.indices[c] = table[slot];
+    }
+
+    mesh.vertices.assign(unique.size() * loaded_vertex_size, 0.0f);
+    parallel_for(threads, threads, [&](size_t t) {
+        for(size_t i = unique.size() * t / threads, last = unique.size() * (t + 1) / threads; i < last; ++i) {
+            const ObjCorner& corner = unique[i];
+            float* vertex = &mesh.vertices[i * loaded_vertex_size];
+            memcpy(vertex, &all_positions[(size_t)corner.v * 3], 3 * sizeof(float));
+            if(corner.vn != missing_index)
+                memcpy(vertex + 3, &all_normals[(size_t)corner.vn * 3], 3 * sizeof(float));
+            if(corner.vt != missing_index)
+                memcpy(vertex + 6, &all_texcoords[(size_t)corner.vt * 2], 2 * sizeof(float));
+        }
+    });
+    return true;
+}
+
+// PLY
+
+enum PlyType {
+    PLY_INT8, PLY_UINT8, PLY_INT16, PLY_UINT16, PLY_INT32, PLY_UINT32, PLY_FLOAT32, PLY_FLOAT64, PLY_UNKNOWN
+};
+
+struct PlyProperty {
+    std::string name;
+    PlyType     type;
+    bool        list;
+    PlyType     count_type;
+    int         target;     // Vertex float slot, -1 when ignored
+};
+
+struct PlyElement {
+    std::string name;
+    size_t      count;
+    std::vector<PlyProperty> properties;
+};
+
+static PlyType ply_type(const std::string& name) {
+    if(name == "char"   || name == "int8")    return PLY_INT8;
+    if(name == "uchar"  || name == "uint8")   return PLY_UINT8;
+    if(name == "short"  || name == "int16")   return PLY_INT16;
+    if(name == "ushort" || name == "uint16")  return PLY_UINT16;
+    if(name == "int"    || name == "int32")   return PLY_INT32;
+    if(name == "uint"   || name == "uint32")  return PLY_UINT32;
+    if(name == "float"  || name == "float32") return PLY_FLOAT32;
+    if(name == "double" || name == "float64") return PLY_FLOAT64;
+    return PLY_UNKNOWN;
+}
+
+static size_t ply_type_size(PlyType type) {
+    static const size_t sizes[] = { 1, 1, 2, 2, 4, 4, 4, 8, 0 };
+    return sizes[type];
+}
+
+static int ply_vertex_target(const std::string& name) {
+    static const char* names[][3] = {
+        { "x", NULL, NULL }, { "y", NULL, NULL }, { "z", NULL, NULL },
+        { "nx", NULL, NULL }, { "ny", NULL, NULL }, { "nz", NULL, NULL },
+        { "u", "s", "texture_u" }, { "v", "t", "texture_v" }
+    };
+    for(int target = 0; target < 8; ++target)
+        for(int i = 0; i < 3 && names[target][i]; ++i)
+            if(name == names[target][i])
+                return target;
+    return -1;
+}
+
+// Binary little endian value converted to double
+static inline double read_ply_value(const char* p, PlyType type) {
+    switch(type) {
+    case PLY_INT8:    { int8_t   v; memcpy(&v, p, 1); return v; }
+    case PLY_UINT8:   { uint8_t  v; memcpy(&v, p, 1); return v; }
+    case PLY_INT16:   { int16_t  v; memcpy(&v, p, 2); return v; }
+    case PLY_UINT16:  { uint16_t v; memcpy(&v, p, 2); return v; }
+    case PLY_INT32:   { int32_t  v; memcpy(&v, p, 4); return v; }
+    case PLY_UINT32:  { uint32_t v; memcpy(&v, p, 4); return v; }
+    case PLY_FLOAT32: { float    v; memcpy(&v, p, 4); return v; }
+    case PLY_FLOAT64: { double   v; memcpy(&v, p, 8); return v; }
+    default:          return 0.0;
+    }
+}
+
+static bool is_face_indices(const PlyProperty& property) {
+    return property.list && (property.name == "vertex_indices" || property.name == "vertex_index");
+}
+
+// Fan triangulation of polygon
+static inline bool add_ply_polygon(const uint32_t* polygon, size_t count, size_t vertices, std::vector<uint32_t>& indices) {
+    for(size_t i = 0; i < count; ++i)
+        if(polygon[i] >= vertices)
+            return false;
+    for(size_t i = 2; i < count; ++i) {
+        indices.push_back(polygon[0]);
+        indices.push_back(polygon[i - 1]);
+        indices.push_back(polygon[i]);
+    }
+    return true;
+}
+
+struct PlyTextChunk {
+    TextChunk             text;
+    size_t                first_line;
+    size_t                lines;
+    std::vector<uint32_t> indices;
+    bool                  valid;
+};
+
+static bool parse_ply_ascii_chunk(PlyTextChunk& chunk, const std::vector<PlyElement>& elements,
+                                  const std::vector<size_t>& element_lines, Mesh& mesh) {
+    const char* end = chunk.text.end;
+    const size_t vertices = mesh.vertex_count();
+    std::vector<uint32_t> polygon;
+    size_t line = chunk.first_line;
+
+    for(const char* p = chunk.text.begin; p < end; p = next_line(p, end), ++line) {
+        size_t e = 0;
+        while(e < elements.size() && line >= element_lines[e + 1])
+            ++e;
+        if(e == elements.size())
+            break;
+
+        const PlyElement& element = elements[e];
+        const bool is_vertex = element.name == "vertex";
+        const bool is_face = element.name == "face";
+        if(!is_vertex && !is_face)
+            continue;
+
+        float* vertex = is_vertex ? &mesh.vertices[(line - element_lines[e]) * loaded_vertex_size] : NULL;
+        for(const PlyProperty& property : element.properties) {
+            if(!property.list) {
+                float value;
+                p = parse_float(p, end, value);
+                if(!p) return false;
+                if(vertex && property.target >= 0)
+                    vertex[property.target] = value;
+                continue;
+            }
+
+            // Every list value takes at least one character
+            size_t count = 0;
+            p = parse_integer(p, end, count);
+            if(!p || count > (size_t)(end - p)) return false;
+            polygon.resize(count);
+            for(size_t i = 0; i < count; ++i) {
+                p = parse_integer(p, end, polygon[i]);
+                if(!p) return false;
+            }
+            if(is_face && is_face_indices(property) &&
+               !add_ply_polygon(polygon.data(), count, vertices, chunk.indices))
+                return false;
+        }
+    }
+    return true;
+}
+
+static size_t ply_element_size(const PlyElement& element, const char* p, const char* end) {
+    size_t size = 0;
+    for(const PlyProperty& property : element.properties) {
+        if(!property.list) {
+            size += ply_type_size(property.type);
+            continue;
+        }
+        if(p + size + ply_type_size(property.count_type) > end)
+            return 0;
+        size_t count = (size_t)read_ply_value(p + size, property.count_type);
+        size += ply_type_size(property.count_type);
+        if(count > (size_t)(end - p - size) / ply_type_size(property.type))
+            return 0;
+        size += count * ply_type_size(property.type);
+    }
+    return size;
+}
+
+static bool parse_ply_binary(const char* p, const char* end, const std::vector<PlyElement>& elements,
+                             unsigned int threads, Mesh& mesh) {
+    const size_t vertices = mesh.vertex_count();
+    std::vector<uint32_t> polygon;
+
+    for(const PlyElement& element : elements) {
+        bool fixed_size = true;
+        size_t stride = 0;
+        for(const PlyProperty& property : element.properties) {
+            fixed_size = fixed_size && !property.list;
+            stride += ply_type_size(property.type);
+        }
+
+        // Vertex records have fixed size and are converted in parallel
+        if(element.name == "vertex" && fixed_size) {
+            if(p + stride * element.count > end)
+                return false;
+            parallel_for(threads, threads, [&](size_t t) {
+                for(size_t i = element.count * t / threads, last = element.count * (t + 1) / threads; i < last; ++i) {
+                    const char* record = p + i * stride;
+                    float* vertex = &mesh.vertices[i * loaded_vertex_size];
+                    for(const PlyProperty& property : element.properties) {
+                        if(property.target >= 0)
+                            vertex[property.target] = (float)read_ply_value(record, property.type);
+                        record += ply_type_size(property.type);
+                    }
+                }
+            });
+            p += stride * element.count;
+            continue;
+        }
+
+        for(size_t i = 0; i < element.count; ++i) {
+            const size_t size = ply_element_size(element, p, end);
+            if(size == 0 || p + size > end)
+                return false;
+            if(element.name == "face") {
+                const char* record = p;
+                for(const PlyProperty& property : element.properties) {
+                    if(!property.list) {
+                        record += ply_type_size(property.type);
+                        continue;
+                    }
+                    size_t count = (size_t)read_ply_value(record, property.count_type);
+                    record += ply_type_size(property.count_type);
+                    if(is_face_indices(property)) {
+                        polygon.resize(count);
+                        for(size_t k = 0; k < count; ++k)
+                            polygon[k] = (uint32_t)read_ply_value(record + k * ply_type_size(property.type), property.type);
+                        if(!add_ply_polygon(polygon.data(), count, vertices, mesh.indices))
+                            return false;
+                    }
+                    record += count * ply_type_size(property.type);
+                }
+            }
+            p += size;
+        }
+    }
+    return true;
+}
+
+bool load_ply(const char* path, Mesh& mesh, unsigned int threads) {
+    MappedFile file;
+    if(!file.open(path))
+        return false;
+
+    const char* data = file.data();
+    const char* end = data + file.size();
+    const char* header_end = NULL;
+    for(const char* p = data; p < end; p = next_line(p, end)) {
+        if(strncmp(p, "end_header", 10) == 0) {
+            header_end = next_line(p, end);
+            break;
+        }
+    }
+    if(file.size() < 4 || strncmp(data, "ply", 3) != 0 || !header_end) {
+        std::cerr << "Error : invalid PLY header in " << path << std::endl;
+        return false;
+    }
+
+    // Header is small, stream parsing is fine here
+    std::istringstream header(std::string(data, header_end - data));
+    std::string line, format;
+    std::vector<PlyElement> elements;
+    while(std::getline(header, line)) {
+        std::istringstream words(line);
+        std::string keyword;
+        words >> keyword;
+        if(keyword == "format") {
+            words >> format;
+        } else if(keyword == "element") {
+            PlyElement element;
+            words >> element.name >> element.count;
+            elements.push_back(element);
+        } else if(keyword == "property" && !elements.empty()) {
+            PlyProperty property;
+            std::string type;
+            words >> type;
+            property.list = type == "list";
+            property.count_type = PLY_UNKNOWN;
+            if(property.list) {
+                std::string count_type;
+                words >> count_type >> type;
+                property.count_type = ply_type(count_type);
+            }
+            property.type = ply_type(type);
+            words >> property.name;
+            property.target = elements.back().name == "vertex" ? ply_vertex_target(property.name) : -1;
+            if(property.type == PLY_UNKNOWN || (property.list && property.count_type == PLY_UNKNOWN)) {
+                std::cerr << "Error : unknown PLY property type in " << path << std::endl;
+                return false;
+            }
+            elements.back().properties.push_back(property);
+        }
+    }
+
+    // Counts are checked against file size before anything is allocated : ASCII
+    // record is at least one byte, binary one at least its fixed part
+    const bool binary = format == "binary_little_endian";
+    size_t remaining = end - header_end;
+    for(const PlyElement& element : elements) {
+        size_t record_size = 0;
+        for(const PlyProperty& property : element.properties)
+            record_size += binary ? ply_type_size(property.list ? property.count_type : property.type) : 0;
+        record_size = std::max<size_t>(record_size, 1);
+        if(element.count > remaining / record_size) {
+            std::cerr << "Error : failed to parse " << path << std::endl;
+            return false;
+        }
+        remaining -= element.count * record_size;
+    }
+
+    size_t vertices = 0;
+    for(const PlyElement& element : elements)
+        if(element.name == "vertex")
+            vertices = element.count;
+
+    threads = thread_count(threads);
+    mesh.vertex_size = loaded_vertex_size;
+    mesh.vertices.assign(vertices * loaded_vertex_size, 0.0f);
+    mesh.indices.clear();
+
+    if(binary) {
+        if(!parse_ply_binary(header_end, end, elements, threads, mesh)) {
+            std::cerr << "Error : failed to parse " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    if(format != "ascii") {
+        std::cerr << "Error : unsupported PLY format " << format << " in " << path << std::endl;
+        return false;
+    }
+
+    // Every element record is one line, lines are counted first to know
+    // which element every chunk line belongs to
+    std::vector<size_t> element_lines(1, 0);
+    for(const PlyElement& element : elements)
+        element_lines.push_back(element_lines.back() + element.count);
+
+    const size_t min_chunk_size = 1 << 20;
+    size_t chunks_count = (end - header_end) / min_chunk_size + 1;
+    if(chunks_count > threads * 4)
+        chunks_count = threads * 4;
+
+    std::vector<TextChunk> text = split_lines(header_end, end, chunks_count);
+    std::vector<PlyTextChunk> chunks(text.size());
+    parallel_for(chunks.size(), threads, [&](size_t i) {
+        chunks[i].text = text[i];
+        chunks[i].lines = 0;
+        for(const char* p = text[i].begin; p < text[i].end; p = next_line(p, text[i].end))
+            ++chunks[i].lines;
+    });
+
+    size_t lines = 0;
+    for(PlyTextChunk& chunk : chunks) {
+        chunk.first_line = lines;
+        lines += chunk.lines;
+    }
+
+    parallel_for(chunks.size(), threads, [&](size_t i) {
+        chunks[i].valid = parse_ply_ascii_chunk(chunks[i], elements, element_lines, mesh);
+    });
+
+    size_t indices = 0;
+    for(const PlyTextChunk& chunk : chunks) {
+        if(!chunk.valid) {
+            std::cerr << "Error : failed to parse " << path << std::endl;
+            return false;
+        }
+        indices += chunk.indices.size();
+    }
+
+    mesh.indices.reserve(indices);
+    for(const PlyTextChunk& chunk : chunks)
+        mesh.indices.insert(mesh.indices.end(), chunk.indices.begin(), chunk.indices.end());
+    return true;
+}
+
+bool load_mesh(const char* path, Mesh& mesh, unsigned int threads) {
+    const char* extension = strrchr(path, '.');
+    if(extension && (strcmp(extension, ".obj") == 0 || strcmp(extension, ".OBJ") == 0))
+        return load_obj(path, mesh, threads);
+    if(extension && (strcmp(extension, ".ply") == 0 || strcmp(extension, ".PLY") == 0))
+        return load_ply(path, mesh, threads);
+
+    std::cerr << "Error : unknown mesh format " << path << std::endl;
+    return false;
+}
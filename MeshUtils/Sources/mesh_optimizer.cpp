@@ -0,0 +1,307 @@
+#include <mesh_optimizer.h>
+#include <algorithm>  // stable_sort
+#include <cmath>      // sqrt
+#include <cstring>    // memcmp
+
+static const uint32_t invalid_index = 0xffffffff;
+
+static uint32_t hash_vertex(const float* vertex, uint32_t vertex_size) {
+    const uint32_t* words = (const uint32_t*)vertex;
+    uint32_t hash = 2166136261u;
+    for(uint32_t i = 0; i < vertex_size; ++i) {
+        hash ^= words[i];
+        hash *= 16777619u;
+    }
+    // Final mix, low bits are used as table slot
+    hash ^= hash >> 15;
+    hash *= 0x2c1b3c6d;
+    hash ^= hash >> 12;
+    return hash;
+}
+
+void build_indexed_mesh(const float* vertices, size_t vertex_count, uint32_t vertex_size, Mesh& mesh) {
+    const size_t vertex_bytes = sizeof(float) * vertex_size;
+
+    // Open addressing, load factor below 0.5
+    size_t table_size = 1;
+    while(table_size < vertex_count * 2)
+        table_size <<= 1;
+    const size_t mask = table_size - 1;
+    std::vector<uint32_t> table(table_size, invalid_index);
+
+    mesh.vertex_size = vertex_size;
+    mesh.vertices.clear();
+    mesh.vertices.reserve(vertex_count * vertex_size);
+    mesh.indices.resize(vertex_count);
+
+    uint32_t unique = 0;
+    for(size_t i = 0; i < vertex_count; ++i) {
+        const float* vertex = vertices + i * vertex_size;
+        size_t slot = hash_vertex(vertex, vertex_size) & mask;
+        while(table[slot] != invalid_index &&
+              memcmp(&mesh.vertices[(size_t)table[slot] * vertex_size], vertex, vertex_bytes) != 0)
+            slot = (slot + 1) & mask;
+
+        if(table[slot] == invalid_index) {
+            table[slot] = unique++;
+            mesh.vertices.insert(mesh.vertices.end(), vertex, vertex + vertex_size);
+        }
+        mesh.indices[i] = table[slot];
+    }
+}
+
+// Vertex to triangles adjacency in compressed form
+struct Adjacency {
+    std::vector<uint32_t> offsets;      // Vertex triangles start, vertex_count + 1 items
+    std::vector<uint32_t> triangles;
+    std::vector<uint32_t> counts;       // Triangles per vertex
+};
+
+static void build_adjacency(const std::vector<uint32_t>& indices, size_t vertex_count, Adjacency& adjacency) {
+    adjacency.counts.assign(vertex_count, 0);
+    for(uint32_t index : indices)
+        ++adjacency.counts[index];
+
+    adjacency.offsets.resize(vertex_count + 1);
+    adjacency.offsets[0] = 0;
+    for(size_t v = 0; v < vertex_count; ++v)
+        adjacency.offsets[v + 1] = adjacency.offsets[v] + adjacency.counts[v];
+
+    std::vector<uint32_t> cursor(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+    adjacency.triangles.resize(indices.size());
+    for(size_t i = 0; i < indices.size(); ++i)
+        adjacency.triangles[cursor[indices[i]]++] = (uint32_t)(i / 3);
+}
+
+void optimize_vertex_cache(Mesh& mesh, uint32_t cache_size) {
+    const size_t vertex_count = mesh.vertex_count();
+    const size_t triangle_count = mesh.triangle_count();
+    if(triangle_count == 0)
+        return;
+
+    Adjacency adjacency;
+    build_adjacency(mesh.indices, vertex_count, adjacency);
+    std::vector<uint32_t>& live = adjacency.counts;
+
+    std::vector<uint32_t> timestamps(vertex_count, 0);
+    std::vector<char>     emitted(triangle_count, 0);
+    std::vector<uint32_t> dead_end;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> output;
+    output.reserve(mesh.indices.size());
+    dead_end.reserve(mesh.indices.size());
+
+    uint32_t time = cache_size + 1;
+    size_t   cursor = 1;
+    int64_t  fanning = 0;
+
+    while(fanning >= 0) {
+        // Emit all remaining triangles around fanning vertex
+        candidates.clear();
+        for(uint32_t k = adjacency.offsets[fanning]; k < adjacency.offsets[fanning + 1]; ++k) {
+            const uint32_t triangle = adjacency.triangles[k];
+            if(emitted[triangle])
+                continue;
+
+            for(int c = 0; c < 3; ++c) {
+                const uint32_t v = mesh.indices[triangle * 3 + c];
+                output.push_back(v);
+                dead_end.push_back(v);
+                candidates.push_back(v);
+                --live[v];
+                if(time - timestamps[v] > cache_size)
+                    timestamps[v] = time++;
+            }
+            emitted[triangle] = 1;
+        }
+
+        // Next fanning vertex : one that stays in cache after its fan is emitted
+        fanning = -1;
+        int64_t best_priority = -1;
+        for(uint32_t v : candidates) {
+            if(live[v] == 0)
+                continue;
+            int64_t priority = 0;
+            if(time - timestamps[v] + 2 * live[v] <= cache_size)
+                priority = time - timestamps[v];
+            if(priority > best_priority) {
+                best_priority = priority;
+                fanning = v;
+            }
+        }
+
+        // Dead end : recently used vertex, otherwise any vertex with triangles left
+        while(fanning < 0 && !dead_end.empty()) {
+            const uint32_t v = dead_end.back();
+            dead_end.pop_back();
+            if(live[v] > 0)
+                fanning = v;
+        }
+        while(fanning < 0 && cursor < vertex_count) {
+            if(live[cursor] > 0)
+                fanning = cursor;
+            ++cursor;
+        }
+    }
+
+    mesh.indices.swap(output);
+}
+
+void optimize_overdraw(Mesh& mesh, uint32_t cache_size) {
+    const size_t vertex_count = mesh.vertex_count();
+    const size_t triangle_count = mesh.triangle_count();
+    if(triangle_count == 0 || mesh.vertex_size < 3)
+        return;
+
+    // Cluster starts where cache simulation misses whole triangle
+    std::vector<uint32_t> cluster_starts;
+    std::vector<uint32_t> timestamps(vertex_count, 0);
+    uint32_t time = cache_size + 1;
+    for(size_t t = 0; t < triangle_count; ++t) {
+        int misses = 0;
+        for(int c = 0; c < 3; ++c) {
+            const uint32_t v = mesh.indices[t * 3 + c];
+            if(time - timestamps[v] > cache_size) {
+                timestamps[v] = time++;
+                ++misses;
+            }
+        }
+        if(misses == 3 || t == 0)
+            cluster_starts.push_back((uint32_t)t);
+    }
+    cluster_starts.push_back((uint32_t)triangle_count);
+
+    auto position = [&](uint32_t index) {
+        return &mesh.vertices[(size_t)index * mesh.vertex_size];
+    };
+
+    double mesh_center[3] = { 0.0, 0.0, 0.0 };
+    for(size_t v = 0; v < vertex_count; ++v)
+        for(int c = 0; c < 3; ++c)
+            mesh_center[c] += position((uint32_t)v)[c];
+    for(int c = 0; c < 3; ++c)
+        mesh_center[c] /= vertex_count;
+
+    // Clusters facing away from mesh center are outer surface, draw them first
+    struct Cluster {
+        uint32_t first, last;
+        double   sort_key;
+    };
+    std::vector<Cluster> clusters(cluster_starts.size() - 1);
+    for(size_t i = 0; i < clusters.size(); ++i) {
+        Cluster& cluster = clusters[i];
+        cluster.first = cluster_starts[i];
+        cluster.last = cluster_starts[i + 1];
+
+        double center[3] = { 0.0, 0.0, 0.0 }, normal[3] = { 0.0, 0.0, 0.0 }, area = 0.0;
+        for(uint32_t t = cluster.first; t < cluster.last; ++t) {
+            const float* a = position(mesh.indices[t * 3 + 0]);
+            const float* b = position(mesh.indices[t * 3 + 1]);
+            const float* c = position(mesh.indices[t * 3 + 2]);
+            const double ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+            const double ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+            // Cross product length is doubled triangle area, so sum is area weighted
+            const double n[3] = {
+                ab[1] * ac[2] - ab[2] * ac[1],
+                ab[2] * ac[0] - ab[0] * ac[2],
+                ab[0] * ac[1] - ab[1] * ac[0]
+            };
+            const double triangle_area = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            for(int k = 0; k < 3; ++k) {
+                normal[k] += n[k];
+                center[k] += (a[k] + b[k] + c[k]) / 3.0 * triangle_area;
+            }
+            area += triangle_area;
+        }
+
+        const double length = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        cluster.sort_key = 0.0;
+        if(area > 0.0 && length > 0.0)
+            for(int k = 0; k < 3; ++k)
+                cluster.sort_key += (center[k] / area - mesh_center[k]) * normal[k] / length;
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& lhs, const Cluster& rhs) {
+        return lhs.sort_key > rhs.sort_key;
+    });
+
+    std::vector<uint32_t> output;
+    output.reserve(mesh.indices.size());
+    for(const Cluster& cluster : clusters)
+        output.insert(output.end(), mesh.indices.begin() + cluster.first * 3, mesh.indices.begin() + cluster.last * 3);
+    mesh.indices.swap(output);
+}
+
+void optimize_vertex_fetch(Mesh& mesh) {
+    const size_t vertex_count = mesh.vertex_count();
+    const uint32_t vertex_size = mesh.vertex_size;
+
+    std::vector<uint32_t> remap(vertex_count, invalid_index);
+    std::vector<float> vertices;
+    vertices.reserve(mesh.vertices.size());
+
+    // Unreferenced vertices are dropped
+    uint32_t next = 0;
+    for(uint32_t& index : mesh.indices) {
+        if(remap[index] == invalid_index) {
+            remap[index] = next++;
+            const float* vertex = &mesh.vertices[(size_t)index * vertex_size];
+            vertices.insert(vertices.end(), vertex, vertex + vertex_size);
+        }
+        index = remap[index];
+    }
+    mesh.vertices.swap(vertices);
+}
+
+VertexCacheStatistics analyze_vertex_cache(const Mesh& mesh, uint32_t cache_size) {
+    VertexCacheStatistics statistics = { 0.0f, 0.0f };
+    const size_t vertex_count = mesh.vertex_count();
+    if(mesh.indices.empty() || vertex_count == 0)
+        return statistics;
+
+    std::vector<uint32_t> timestamps(vertex_count, 0);
+    uint32_t time = cache_size + 1;
+    size_t transformed = 0;
+    for(uint32_t index : mesh.indices) {
+        if(time - timestamps[index] > cache_size) {
+            timestamps[index] = time++;
+            ++transformed;
+        }
+    }
+
+    statistics.acmr = (float)transformed / mesh.triangle_count();
+    statistics.atvr = (float)transformed / vertex_count;
+    return statistics;
+}
+
+float analyze_vertex_fetch(const Mesh& mesh) {
+    const size_t vertex_count = mesh.vertex_count();
+    if(mesh.indices.empty() || vertex_count == 0)
+        return 0.0f;
+
+    const size_t line_size = 64, lines_count = 256;
+    const size_t vertex_bytes = sizeof(float) * mesh.vertex_size;
+    std::vector<size_t> lines(lines_count, (size_t)-1);
+
+    // Only post-transform cache misses fetch vertex data
+    const uint32_t cache_size = 16;
+    std::vector<uint32_t> timestamps(vertex_count, 0);
+    uint32_t time = cache_size + 1;
+
+    size_t fetched = 0;
+    for(uint32_t index : mesh.indices) {
+        if(time - timestamps[index] <= cache_size)
+            continue;
+        timestamps[index] = time++;
+
+        const size_t start = index * vertex_bytes, end = start + vertex_bytes;
+        for(size_t line = start / line_size; line <= (end - 1) / line_size; ++line) {
+            size_t& slot = lines[line % lines_count];
+            if(slot != line) {
+                slot = line;
+                fetched += line_size;
+            }
+        }
+    }
+    return (float)fetched / (vertex_count * vertex_bytes);
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// S3TC block formats, 4x4 pixel blocks
+enum BlockFormat {
+    BLOCK_BC1,      // DXT1 : RGB, 8 bytes per block (4 bpp)
+    BLOCK_BC3       // DXT5 : RGBA, 16 bytes per block (8 bpp)
+};
+
+size_t block_size(BlockFormat format);
+
+// Compressed size of width x height image, partial blocks are padded
+size_t compressed_size(BlockFormat format, int width, int height);
+
+// Compresses RGBA8 image (tightly packed rows), pixels outside of image
+// in edge blocks repeat edge pixels. Endpoints are taken along principal
+// axis of block colors, inset and rounded to RGB565.
+void compress_image(BlockFormat format, const uint8_t* rgba, int width, int height, uint8_t* destination);
+
+// Single 4x4 block, rgba holds 16 pixels in row order
+void compress_bc1_block(const uint8_t* rgba, uint8_t* destination);
+void compress_bc3_block(const uint8_t* rgba, uint8_t* destination);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <block_compression.h>
+#include <glad/gl.h>
+#include <string>
+#include <vector>
+
+// EXT_texture_compression_s3tc, not in generated loader
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT   0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT  0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT  0x83F2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT  0x83F3
+
+// EXT_texture_sRGB, same blocks decoded as sRGB
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT        0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT  0x8C4D
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT  0x8C4E
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT  0x8C4F
+
+struct CompressedLevel {
+    int    width;
+    int    height;
+    size_t offset;      // In CompressedImage::data
+    size_t size;
+};
+
+// Block compressed image with mip chain, level 0 is largest
+struct CompressedImage {
+    GLenum                       format;    // GL_COMPRESSED_* internal format
+    std::vector<CompressedLevel> levels;
+    std::vector<unsigned char>   data;
+};
+
+GLenum block_gl_format(BlockFormat format);
+
+// DDS container with DXT1, DXT3 or DXT5 data
+bool read_dds(const char* path, CompressedImage& image);
+bool write_dds(const char* path, const CompressedImage& image);
+
+// Path ends with .dds
+bool is_dds_path(const std::string& path);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <glad/gl.h>
+
+// Generated glad loader covers GL 3.3 only, newer features are checked here
+// and must be checked for availability before use
+
+// GL 4.6, GL_ARB_texture_filter_anisotropic or GL_EXT_texture_filter_anisotropic
+#ifndef GL_TEXTURE_MAX_ANISOTROPY
+#define GL_TEXTURE_MAX_ANISOTROPY 0x84FE
+#endif
+
+#ifndef GL_MAX_TEXTURE_MAX_ANISOTROPY
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY 0x84FF
+#endif
+
+struct GLExtensions {
+    GLint   major_version;
+    GLint   minor_version;
+    bool    texture_filter_anisotropic;
+    GLfloat max_anisotropy;                 // 1 without anisotropic filtering
+    bool    snorm_gl42;                     // GL 4.2 signed normalized decoding, max(c / (2^(b-1) - 1), -1)
+};
+
+extern GLExtensions gl_extensions;
+
+// Must be called after gladLoadGL with current context
+void load_gl_extensions();
+
+bool has_gl_extension(const char* name);
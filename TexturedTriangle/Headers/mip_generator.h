@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+enum MipFilter {
+    MIP_FILTER_BOX,         // 2x2 average
+    MIP_FILTER_KAISER       // 8 tap windowed sinc (Kaiser window, alpha 4), sharper
+};
+
+struct MipLevel {
+    int                  width;
+    int                  height;
+    std::vector<uint8_t> pixels;    // Tightly packed rows
+};
+
+// Downsamples 8 bit RGB or RGBA image to max(1, width / 2) x max(1, height / 2).
+// sRGB color channels are filtered in linear space through lookup tables,
+// alpha is always linear. Rows are split between threads, 0 uses all hardware
+// threads, small images are done by calling thread.
+void generate_mip(const uint8_t* source, int width, int height, int channels, bool srgb,
+                  MipFilter filter, MipLevel& destination, unsigned int threads = 0);
+
+// All levels after level 0 down to 1x1
+void generate_mip_chain(const uint8_t* pixels, int width, int height, int channels, bool srgb,
+                        MipFilter filter, std::vector<MipLevel>& levels, unsigned int threads = 0);
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <cstddef>
+#include <cstdint>
+
+// Pixel conversion kernels for texture uploads. Drivers store 8 bit color
+// textures as RGBA, so 3 channel data is expanded here instead of by driver.
+// SSSE3/AVX2 versions are used when CPU supports them, source and destination
+// must not overlap unless stated.
+
+// RGB -> RGBA with opaque alpha
+void convert_rgb_to_rgba(const uint8_t* source, uint8_t* destination, size_t pixels);
+
+// BGR -> RGBA with opaque alpha
+void convert_bgr_to_rgba(const uint8_t* source, uint8_t* destination, size_t pixels);
+
+// BGRA <-> RGBA, source may be equal to destination
+void swizzle_bgra_to_rgba(const uint8_t* source, uint8_t* destination, size_t pixels);
+
+// Color multiplied by alpha in place, for (GL_ONE, GL_ONE_MINUS_SRC_ALPHA) blending
+void premultiply_alpha(uint8_t* rgba, size_t pixels);
+
+// Any 1-4 channel image (gray, gray + alpha, RGB, RGBA) -> RGBA
+void convert_to_rgba(const uint8_t* source, int channels, uint8_t* destination, size_t pixels);
+
+// Largest GL_UNPACK_ALIGNMENT (8, 4, 2, 1) matching row size
+GLint unpack_alignment(size_t row_bytes);
+
+// Internal format of color texture : sRGB tagged formats make sampler
+// decode to linear before filtering
+GLint color_internal_format(int channels, bool srgb);
+
+// Color textures are sRGB tagged only when framebuffer encodes written values
+// back to sRGB, otherwise sampled values are written unchanged. Set once
+// after context creation, before loaders start.
+void set_srgb_color_textures(bool enable);
+bool srgb_color_textures();
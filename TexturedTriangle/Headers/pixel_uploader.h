@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <vector>
+
+// Pixels of one mip level, rows follow GL_UNPACK_ALIGNMENT
+struct PixelLevel {
+    GLsizei     width;
+    GLsizei     height;
+    const void* pixels;
+    GLsizeiptr  size;
+};
+
+// Texture uploads through pool of pixel buffer objects. Pixels are copied
+// into staging buffer and glTexSubImage2D reads them from GL_PIXEL_UNPACK_BUFFER,
+// so call returns without waiting for driver copy and transfer overlaps
+// rendering. Fence marks when GPU has finished reading buffer and it can be reused.
+class PixelUploader {
+    struct Staging {
+        GLuint     pbo_id;
+        GLsizeiptr capacity;
+        GLsync     fence;
+    };
+
+    std::vector<Staging> pool;
+
+    Staging* acquire(GLsizeiptr size);
+public:
+    explicit PixelUploader(unsigned int buffers = 4);
+    PixelUploader(const PixelUploader& rhs) = delete;
+    PixelUploader& operator= (const PixelUploader& rhs) = delete;
+    ~PixelUploader();
+
+    // Writes pixels into level of texture bound to GL_TEXTURE_2D. Level storage is
+    // (re)allocated when internal_format is not 0, otherwise existing storage is
+    // updated with glTexSubImage2D. Returns false when all staging buffers are
+    // still in use, upload should be retried later (next frame).
+    bool upload(GLint level, GLint internal_format, GLsizei width, GLsizei height, GLenum format, GLenum type,
+                const void* pixels, GLsizeiptr size);
+
+    // Levels first_level, first_level + 1, ... through one staging buffer
+    bool upload(GLint internal_format, GLenum format, GLenum type,
+                const PixelLevel* levels, unsigned int count, GLint first_level = 0);
+
+    // Staging buffers still read by GPU
+    unsigned int busy();
+};
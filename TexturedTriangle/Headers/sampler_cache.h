@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <cstddef>
+#include <unordered_map>
+
+// Filtering state of sampler object, overrides texture parameters of unit it is bound to
+struct SamplerDesc {
+    GLint   min_filter;
+    GLint   mag_filter;
+    GLint   wrap_s;
+    GLint   wrap_t;
+    GLfloat anisotropy;     // 1 is off, clamped to GL_MAX_TEXTURE_MAX_ANISOTROPY
+    GLfloat lod_bias;
+
+    bool operator== (const SamplerDesc& rhs) const {
+        return min_filter == rhs.min_filter && mag_filter == rhs.mag_filter && wrap_s == rhs.wrap_s &&
+               wrap_t == rhs.wrap_t && anisotropy == rhs.anisotropy && lod_bias == rhs.lod_bias;
+    }
+};
+
+// Bilinear within level, linear between levels
+SamplerDesc trilinear_sampler(GLint wrap = GL_REPEAT);
+
+// Trilinear with anisotropy samples along screen-space footprint
+SamplerDesc anisotropic_sampler(GLfloat anisotropy, GLint wrap = GL_REPEAT);
+
+// One sampler object per distinct description, created on first request.
+// Needs load_gl_extensions() before first get().
+class SamplerCache {
+    struct Hash {
+        size_t operator() (const SamplerDesc& desc) const;
+    };
+
+    std::unordered_map<SamplerDesc, GLuint, Hash> samplers;
+public:
+    SamplerCache() = default;
+    SamplerCache(const SamplerCache& rhs) = delete;
+    SamplerCache& operator= (const SamplerCache& rhs) = delete;
+    ~SamplerCache();
+
+    GLuint get(const SamplerDesc& desc);
+
+    size_t size() const {
+        return samplers.size();
+    }
+};
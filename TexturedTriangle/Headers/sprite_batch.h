@@ -0,0 +1,62 @@
+#pragma once
+
+#include <texture_atlas.h>
+#include <glad/gl.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Draws textured quads from atlas with one instanced draw call. Every sprite
+// is single instance of 4 vertex strip, quad corners come from gl_VertexID.
+// Batch is flushed when it is full or texture changes.
+class SpriteBatch {
+    struct Sprite {
+        float    x, y, width, height;   // Pixels, origin is lower left corner
+        float    u0, v0, u1, v1;
+        float    layer;
+        uint32_t color;                 // RGBA8, multiplies texture
+    };
+
+    std::vector<Sprite> sprites;
+    size_t              capacity;
+    GLuint              program_id;
+    GLuint              vao_id;
+    GLuint              vbo_id;
+    GLint               viewport_location;
+    GLuint              texture_id;
+    size_t              draw_calls_count;
+public:
+    explicit SpriteBatch(size_t capacity = 16384);
+    SpriteBatch(const SpriteBatch& rhs) = delete;
+    SpriteBatch& operator= (const SpriteBatch& rhs) = delete;
+    ~SpriteBatch();
+
+    // False when shader program failed to build
+    bool valid() const {
+        return program_id != 0;
+    }
+
+    // Binds batch program and vertex array, they stay bound after end()
+    void begin(int viewport_width, int viewport_height);
+
+    // texture is GL_TEXTURE_2D_ARRAY holding region
+    void draw(GLuint texture, const AtlasRegion& region, float x, float y, float width, float height,
+              uint32_t color = 0xffffffff);
+
+    void draw(const TextureAtlas& atlas, int region, float x, float y, float width, float height,
+              uint32_t color = 0xffffffff) {
+        draw(atlas.texture(), atlas.region(region), x, y, width, height, color);
+    }
+
+    // Draws queued sprites
+    void flush();
+
+    void end() {
+        flush();
+    }
+
+    // Draw calls issued since begin()
+    size_t draw_calls() const {
+        return draw_calls_count;
+    }
+};
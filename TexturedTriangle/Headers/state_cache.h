@@ -0,0 +1,48 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <cstddef>
+
+// Binds texture to active unit outside of StateCache (uploads, queries).
+// Caches notice it on their next texture bind and forget texture bindings.
+void bind_texture_direct(GLenum target, GLuint id);
+
+// Shadow copy of bound GL objects, bind calls matching current state are
+// skipped. Textures bound with bind_texture_direct() are noticed, other
+// direct binds and glUseProgram leave copy stale, invalidate() must be called after them.
+class StateCache {
+public:
+    static const unsigned int max_units = 32;
+private:
+    GLuint       program_id;
+    GLuint       vertex_array_id;
+    unsigned int active_unit;
+    GLenum       texture_targets[max_units];
+    GLuint       textures[max_units];
+    GLuint       samplers[max_units];
+    unsigned int direct_binds_seen;
+    size_t       calls_count;
+    size_t       skipped_count;
+
+    void activate(unsigned int unit);
+    void forget_textures();
+public:
+    StateCache();
+
+    void use_program(GLuint id);
+    void bind_vertex_array(GLuint id);
+    void bind_texture(unsigned int unit, GLenum target, GLuint id);
+    void bind_sampler(unsigned int unit, GLuint id);
+
+    // Next calls are issued regardless of shadow copy
+    void invalidate();
+
+    // Bind calls issued to GL and skipped as redundant
+    size_t calls() const {
+        return calls_count;
+    }
+
+    size_t skipped() const {
+        return skipped_count;
+    }
+};
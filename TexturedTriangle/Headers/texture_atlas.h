@@ -0,0 +1,86 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Skyline bottom-left rectangle packer : top edge of packed area is kept as
+// list of horizontal segments, rectangle goes where its top ends lowest.
+class SkylinePacker {
+    struct Segment {
+        int x;
+        int y;
+        int width;
+    };
+
+    int                  width;
+    int                  height;
+    std::vector<Segment> skyline;
+
+    // Top of rectangle placed at segment index, -1 when it does not fit
+    int fit(size_t index, int rect_width, int rect_height) const;
+public:
+    SkylinePacker(int width, int height);
+
+    // Position of rectangle, false when there is no room left
+    bool insert(int rect_width, int rect_height, int& x, int& y);
+};
+
+// Place of image in atlas, texture coordinates exclude border
+struct AtlasRegion {
+    int   layer;
+    int   width;
+    int   height;
+    float u0, v0, u1, v1;
+};
+
+// Packs many small RGBA images into layers of GL_TEXTURE_2D_ARRAY.
+// Every image gets border of its own edge pixels and cell aligned to
+// 2^max_level pixels, so up to max_level no mip texel mixes two images
+// and bilinear filtering does not read neighbours.
+class TextureAtlas {
+    struct Image {
+        int                  width;
+        int                  height;
+        std::vector<uint8_t> pixels;
+    };
+
+    int                      page_size;
+    int                      max_level;
+    std::vector<Image>       images;
+    std::vector<AtlasRegion> regions;
+    GLuint                   texture_id;
+    int                      layers_count;
+public:
+    // Layers are page_size x page_size, power of two sizes keep mips aligned
+    explicit TextureAtlas(int page_size = 2048, int max_level = 3);
+    TextureAtlas(const TextureAtlas& rhs) = delete;
+    TextureAtlas& operator= (const TextureAtlas& rhs) = delete;
+    ~TextureAtlas();
+
+    // Queues image for packing, returns its region index or -1 when image
+    // can not be read or does not fit into page
+    int add(const uint8_t* rgba, int width, int height);
+    int add(const char* path);
+
+    // Packs queued images (largest first), builds sRGB mips and uploads layers.
+    // Source pixels are released afterwards. Returns false on failure.
+    bool build();
+
+    const AtlasRegion& region(int index) const {
+        return regions[index];
+    }
+
+    size_t size() const {
+        return regions.size();
+    }
+
+    GLuint texture() const {
+        return texture_id;
+    }
+
+    int layers() const {
+        return layers_count;
+    }
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <pixel_uploader.h>
+#include <dds_texture.h>
+#include <mip_generator.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Loads textures without blocking render thread : images are decoded and
+// gamma-correct mips are built by worker threads, uploads are done in update() on render (GL context) thread.
+// Until its image is uploaded texture holds placeholder checkerboard.
+// With PixelUploader pixels go through staging buffers instead of client memory.
+class TextureLoader {
+    struct Request {
+        std::string path;
+        GLuint      texture_id;
+        bool        compressed;     // DDS uploaded without decoding
+    };
+
+    struct Image {
+        GLuint                texture_id;
+        std::vector<uint8_t>  pixels;     // RGBA, empty when decoding failed
+        int                   width;
+        int                   height;
+        std::string           path;
+        bool                  compressed;
+        CompressedImage       blocks;
+        std::vector<MipLevel> mips;       // Levels 1..
+    };
+
+    std::vector<std::thread> workers;
+    std::mutex               mutex;
+    std::condition_variable  condition;
+    std::deque<Request>      requests;
+    std::deque<Image>        decoded;
+    size_t                   pending_count;     // Not uploaded yet, touched by render thread only
+    bool                     stopping;
+    PixelUploader*           uploader;
+
+    void work();
+public:
+    // threads = 0 uses hardware threads - 1, but at least one
+    explicit TextureLoader(unsigned int threads = 0, PixelUploader* uploader = NULL);
+    TextureLoader(const TextureLoader& rhs) = delete;
+    TextureLoader& operator= (const TextureLoader& rhs) = delete;
+    ~TextureLoader();
+
+    // Creates texture with placeholder image and queues file for decoding
+    GLuint load(const char* path);
+
+    // Queues file for decoding into existing texture, it keeps current image until upload
+    void reload(GLuint texture_id, const char* path);
+
+    // Uploads decoded images until time budget (seconds) is spent, at least
+    // one image is uploaded if any is ready and staging buffer is free.
+    // Textures done (uploaded or failed) are appended to finished.
+    // Returns uploaded images count.
+    unsigned int update(double budget, std::vector<GLuint>* finished = NULL);
+
+    // Textures still holding placeholder
+    size_t pending() const {
+        return pending_count;
+    }
+};
+
+// Decodes any image into RGBA, 3 channel data is expanded by SIMD kernel
+// instead of driver at upload time. Does not need GL context.
+bool decode_rgba(const char* path, int& width, int& height, std::vector<uint8_t>& rgba);
+
+// S3TC support of current context, checked once
+bool s3tc_supported();
+
+// sRGB variant of S3TC format : cooker builds mips of color textures in
+// linear space, blocks hold sRGB values
+GLenum srgb_compressed_format(GLenum format);
+
+// Uploads all levels into texture bound to GL_TEXTURE_2D with glCompressedTexImage2D
+void upload_compressed(const CompressedImage& image);
+
+// Synchronous load : decode, CPU mipmaps and upload, 0 on failure.
+// DDS files keep their block compressed mip chain when S3TC is supported,
+// otherwise SOIL decodes them like other images.
+GLuint load_texture(const char* path);
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <texture_loader.h>
+#include <glad/gl.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+typedef size_t TextureHandle;
+
+// Texture memory of GL_TEXTURE_BASE_LEVEL .. GL_TEXTURE_MAX_LEVEL of texture bound to GL_TEXTURE_2D
+size_t texture_bytes();
+
+// Keeps textures within memory budget. Every texture is tracked with its
+// size including mips and frame it was last used in. When usage is over
+// budget least recently used textures are downgraded (top mip level is
+// dropped on GPU, at most once per frame) and small ones are evicted. Using downgraded or evicted texture
+// again reloads it through TextureLoader, renderer only sees texture id.
+class TextureManager {
+    enum State {
+        STATE_LOADING,      // Waiting for loader, placeholder or lower mips are shown
+        STATE_RESIDENT,
+        STATE_DOWNGRADED,
+        STATE_EVICTED
+    };
+
+    struct Entry {
+        std::string path;
+        GLuint      texture_id;
+        State       state;
+        size_t      bytes;
+        uint64_t    last_used;
+        uint64_t    downgraded_frame;
+    };
+
+    TextureLoader&                          loader;
+    size_t                                  budget_bytes;
+    std::vector<Entry>                      entries;
+    std::unordered_map<std::string, size_t> handles;
+    std::vector<GLuint>                     finished;
+    uint64_t                                frame;
+    size_t                                  usage_bytes;
+    size_t                                  evictions_count;
+    size_t                                  downgrades_count;
+    size_t                                  reloads_count;
+
+    void measure(Entry& entry);
+    bool downgrade(Entry& entry);
+    void evict(Entry& entry);
+public:
+    TextureManager(TextureLoader& loader, size_t budget_bytes);
+    TextureManager(const TextureManager& rhs) = delete;
+    TextureManager& operator= (const TextureManager& rhs) = delete;
+    ~TextureManager();
+
+    // Starts loading, same path gives same handle
+    TextureHandle add(const char* path);
+
+    // Texture id to bind this frame, texture is protected from eviction until next update()
+    GLuint use(TextureHandle handle);
+
+    // Uploads loaded images within time budget (seconds), then shrinks
+    // textures not used in this frame until usage fits budget
+    void update(double upload_budget);
+
+    void set_budget(size_t bytes) {
+        budget_bytes = bytes;
+    }
+
+    size_t budget() const {
+        return budget_bytes;
+    }
+
+    size_t usage() const {
+        return usage_bytes;
+    }
+
+    size_t evictions() const {
+        return evictions_count;
+    }
+
+    size_t downgrades() const {
+        return downgrades_count;
+    }
+
+    size_t reloads() const {
+        return reloads_count;
+    }
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <mip_generator.h>
+#include <glad/gl.h>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Streams mip levels into textures as they are needed on screen. Worker
+// decodes image and its mip chain, then only levels up to initial size are
+// uploaded. Each frame renderer reports on-screen size of every texture,
+// finer levels are uploaded in row bands within per frame byte budget, and
+// GL_TEXTURE_BASE_LEVEL is moved once level is complete. Levels no longer
+// needed are freed, CPU copy stays for streaming them in again.
+class TextureStreamer {
+    struct Request {
+        size_t      index;
+        std::string path;
+        bool        compressed;
+    };
+
+    struct Decoded {
+        size_t                index;
+        bool                  compressed;
+        GLint                 internal_format;
+        std::vector<MipLevel> levels;     // Empty when decoding failed
+    };
+
+    struct Texture {
+        GLuint                texture_id;
+        GLint                 internal_format;
+        bool                  compressed;
+        std::vector<MipLevel> levels;
+        int                   resident_level;   // Finest complete level, levels.size() when none
+        float                 screen_size;
+        int                   streamed_rows;    // Of level resident_level - 1 in progress, 0 when none
+    };
+
+    std::vector<Texture>     textures;
+    size_t                   frame_budget;
+    int                      initial_size;
+    size_t                   uploaded_bytes;
+    std::thread              worker;
+    std::mutex               mutex;
+    std::condition_variable  condition;
+    std::deque<Request>      requests;
+    std::deque<Decoded>      decoded;
+    bool                     stopping;
+
+    void work();
+    void start(Texture& texture, Decoded& image);
+    size_t stream(Texture& texture, size_t budget);
+    void release(Texture& texture, int level);
+public:
+    // Budget is bytes uploaded per frame, levels not larger than initial_size
+    // are uploaded as soon as image is decoded
+    explicit TextureStreamer(size_t frame_budget = 1024 * 1024, int initial_size = 64);
+    TextureStreamer(const TextureStreamer& rhs) = delete;
+    TextureStreamer& operator= (const TextureStreamer& rhs) = delete;
+    ~TextureStreamer();
+
+    // Creates texture with 1x1 placeholder and queues file for decoding
+    size_t add(const char* path);
+
+    GLuint texture(size_t index) const {
+        return textures[index].texture_id;
+    }
+
+    // Largest on-screen extent of texture in pixels, finest level wanted is
+    // the smallest one still covering it
+    void request(size_t index, float screen_size);
+
+    // Starts decoded textures and streams wanted levels within frame budget.
+    // Returns bytes uploaded.
+    size_t update();
+
+    // Bytes of complete levels in GPU memory
+    size_t resident_bytes() const;
+
+    // Textures still having levels to stream
+    size_t streaming() const;
+};
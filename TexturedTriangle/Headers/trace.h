@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Timeline of named CPU scopes from all threads plus GPU profiler spans, written
+// as Chrome trace JSON (chrome://tracing, ui.perfetto.dev). Every thread records
+// into its own fixed buffer, so recording takes no lock : scope costs two clock
+// reads and one store. Events beyond buffer capacity are dropped.
+//
+// trace_start() once, TRACE_SCOPE("name") in code, trace_write(path) at exit
+
+extern std::atomic<bool> trace_enabled;
+
+// Raw event clock : TSC ticks on x86 (constant rate on current CPUs),
+// steady_clock nanoseconds elsewhere. Calibrated against steady_clock on write.
+inline uint64_t trace_clock() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// Starts recording, events before it are not kept
+void trace_start();
+
+// Track name of calling thread, "thread N" otherwise
+void trace_thread_name(const char* name);
+
+// Name must outlive trace (string literal)
+void trace_record(const char* name, uint64_t begin, uint64_t end);
+
+// Pairs GPU clock with CPU clock, gpu_time is GL_TIMESTAMP read just now
+void trace_sync_gpu_clock(int64_t gpu_time);
+
+// Scope in GPU nanoseconds (GL_TIMESTAMP), placed on separate GPU track
+void trace_gpu_span(const char* name, uint64_t begin, uint64_t end);
+
+// Returns false when file can't be written
+bool trace_write(const char* path);
+
+class TraceScope {
+    const char* name;
+    uint64_t    begin;
+public:
+    explicit TraceScope(const char* scope_name) :
+        name(scope_name), begin(trace_enabled.load(std::memory_order_relaxed) ? trace_clock() : 0) {
+    }
+    TraceScope(const TraceScope& rhs) = delete;
+    TraceScope& operator= (const TraceScope& rhs) = delete;
+
+    ~TraceScope() {
+        if(begin)
+            trace_record(name, begin, trace_clock());
+    }
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+// Records enclosing block while tracing is on
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name)
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Packed attribute types, every format takes multiple of 4 bytes
+enum VertexAttributeFormat {
+    FORMAT_FLOAT2,              // 8 bytes
+    FORMAT_FLOAT3,              // 12 bytes
+    FORMAT_FLOAT4,              // 16 bytes
+    FORMAT_HALF2,               // GL_HALF_FLOAT, 4 bytes
+    FORMAT_HALF4,               // GL_HALF_FLOAT, 8 bytes
+    FORMAT_UNORM8x4,            // GL_UNSIGNED_BYTE normalized, 4 bytes, [0, 1] values
+    FORMAT_UNORM16x2,           // GL_UNSIGNED_SHORT normalized, 4 bytes, [0, 1] values
+    FORMAT_SNORM_2_10_10_10     // GL_INT_2_10_10_10_REV normalized, 4 bytes, [-1, 1] values
+};
+
+struct VertexFormatAttribute {
+    GLuint                location;
+    VertexAttributeFormat format;
+    GLuint                offset;
+};
+
+// Source float data of one attribute : vertex i starts at data + i * stride
+struct VertexSource {
+    const float* data;
+    size_t       stride;        // In floats
+    GLuint       components;    // Missing components are filled with 0, w with 1
+};
+
+// Interleaved vertex layout built from packed attributes
+class VertexFormat {
+    std::vector<VertexFormatAttribute> attributes;
+    GLuint stride;
+public:
+    VertexFormat() : stride(0) {}
+
+    VertexFormat& add(GLuint location, VertexAttributeFormat format);
+
+    GLuint size() const {
+        return stride;
+    }
+
+    // Setup attributes of bound vertex array from buffer bound to GL_ARRAY_BUFFER
+    void apply(size_t base_offset = 0) const;
+
+    // Converts float sources (one per attribute, in add() order) into
+    // interleaved vertices, destination must hold vertices * size() bytes.
+    // Signed normalized formats follow context version, load_gl_extensions() must run first.
+    void pack(const VertexSource* sources, size_t vertices, void* destination) const;
+};
+
+GLuint format_size(VertexAttributeFormat format);
+GLint  format_components(VertexAttributeFormat format);
+
+// Conversion kernels, SSE2/F16C versions are used when CPU supports them
+void pack_half(const float* source, uint16_t* destination, size_t count);
+void pack_unorm8(const float* source, uint8_t* destination, size_t count);
+void pack_unorm16(const float* source, uint16_t* destination, size_t count);
+// GL 4.2 decodes c / 511, so 0 is exact. Earlier versions decode (2c + 1) / 1023,
+// gl42_rule = false encodes for them (0 comes back as +-1/1023).
+void pack_snorm_2_10_10_10(const float* source_xyzw, uint32_t* destination, size_t vectors, bool gl42_rule = true);
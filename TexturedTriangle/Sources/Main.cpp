@@ -1,9 +1,29 @@
+#include <vertex_format.h>
+#include <texture_loader.h>
+#include <mip_generator.h>
+#include <pixel_convert.h>
+#include <sprite_batch.h>
+#include <texture_manager.h>
+#include <texture_streamer.h>
+#include <gl_extensions.h>
+#include <state_cache.h>
+#include <sampler_cache.h>
+#include <frame_pacing.h>
+#include <gpu_profiler.h>
+#include <gl_call_stats.h>
+#include <trace.h>
 #define GLAD_GL_IMPLEMENTATION
 #include <glad/gl.h>
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
-#include <SOIL/SOIL.h>
 #include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <memory>
 
 using namespace std;
 
@@ -62,9 +82,646 @@ GLfloat vertices[] = {
      0.0f,  0.5f, 0.0f,  0.0f, 0.0f, 1.0f,  1.0f, 1.0f  // Top center
 };
 
+// Source vertices are 8 floats : position, color, texture coords
+static const size_t source_vertex_size = 8;
+
+// Packed vertex - 16 bytes instead of 32
+//  _______________________________________________________
+// |                  Vertex 1                 |  Vertex 2 |
+// |___________________|_______________|_______|___________|
+// |  X  |  Y  |  Z  | 1 | R | G | B | A |  S  |  T  | ... |
+// |_____|_____|_____|___|___|___|___|___|_____|_____|_____|
+// |      4 x half     |  4 x unorm8   | 2 x unorm16 |
+//
+//  <--------------------------------------->
+//           step = 16 bytes
+static VertexFormat compact_vertex_format()
+{
+    VertexFormat format;
+    format.add(0, FORMAT_HALF4)         // Position
+          .add(1, FORMAT_UNORM8x4)      // Color
+          .add(2, FORMAT_UNORM16x2);    // Texture coords
+    return format;
+}
+
+static VertexFormat float_vertex_format()
+{
+    VertexFormat format;
+    format.add(0, FORMAT_FLOAT3)
+          .add(1, FORMAT_FLOAT3)
+          .add(2, FORMAT_FLOAT2);
+    return format;
+}
+
+static void pack_vertices(const VertexFormat& format, const GLfloat* source, size_t count, vector<unsigned char>& packed)
+{
+    const VertexSource sources[] = {
+        { source,     source_vertex_size, 3 },
+        { source + 3, source_vertex_size, 3 },
+        { source + 6, source_vertex_size, 2 }
+    };
+    packed.resize(format.size() * count);
+    format.pack(sources, count, packed.data());
+}
+
+// Compares memory, packing speed and GPU draw time of float and compact vertices
+// on large mesh of small triangles, shader program and texture must be bound
+static void run_vertex_format_benchmark(size_t vertices_count)
+{
+    vertices_count -= vertices_count % 3;
+    const GLfloat corners[3][2] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 0.0f, 1.0f } };
+    const GLfloat triangle_size = 0.02f;
+    vector<GLfloat> source(vertices_count * source_vertex_size);
+    for(size_t first = 0; first < vertices_count; first += 3) {
+        const GLfloat x = (GLfloat)rand() / RAND_MAX * 1.9f - 0.95f;
+        const GLfloat y = (GLfloat)rand() / RAND_MAX * 1.9f - 0.95f;
+        for(size_t corner = 0; corner < 3; ++corner) {
+            GLfloat* vertex = &source[(first + corner) * source_vertex_size];
+            vertex[0] = x + corners[corner][0] * triangle_size;
+            vertex[1] = y + corners[corner][1] * triangle_size;
+            vertex[2] = 0.0f;
+            vertex[3] = (GLfloat)rand() / RAND_MAX;
+            vertex[4] = (GLfloat)rand() / RAND_MAX;
+            vertex[5] = (GLfloat)rand() / RAND_MAX;
+            vertex[6] = corners[corner][0];
+            vertex[7] = corners[corner][1];
+        }
+    }
+
+    const VertexFormat formats[2] = { float_vertex_format(), compact_vertex_format() };
+    const char* names[2] = { "float  ", "compact" };
+    const int repeats = 20;
+
+    for(int f = 0; f < 2; ++f) {
+        vector<unsigned char> packed;
+        auto start = chrono::steady_clock::now();
+        pack_vertices(formats[f], source.data(), vertices_count, packed);
+        double pack_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        GLuint vao_id, vbo_id, query_id;
+        glGenVertexArrays(1, &vao_id);
+        glGenBuffers(1, &vbo_id);
+        glGenQueries(1, &query_id);
+        glBindVertexArray(vao_id);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
+        glBufferData(GL_ARRAY_BUFFER, packed.size(), packed.data(), GL_STATIC_DRAW);
+        formats[f].apply();
+
+        // Warm up, then measure
+        glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertices_count);
+        glFinish();
+        glBeginQuery(GL_TIME_ELAPSED, query_id);
+        for(int i = 0; i < repeats; ++i)
+            glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertices_count);
+        glEndQuery(GL_TIME_ELAPSED);
+
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(query_id, GL_QUERY_RESULT, &elapsed);
+        const double draw_time = elapsed * 1e-9 / repeats;
+
+        cout << names[f] << " : " << formats[f].size() << " bytes/vertex"
+             << ", buffer " << packed.size() / (1024.0 * 1024.0) << " MB"
+             << ", pack " << vertices_count * source_vertex_size * sizeof(GLfloat) / pack_time / (1024.0 * 1024.0) << " MB/s"
+             << ", draw " << draw_time * 1000.0 << " ms"
+             << ", fetch " << packed.size() / draw_time / (1024.0 * 1024.0 * 1024.0) << " GB/s" << endl;
+
+        glDeleteQueries(1, &query_id);
+        glDeleteBuffers(1, &vbo_id);
+        glDeleteVertexArrays(1, &vao_id);
+    }
+}
+
+// Texture uploads per frame stop after this time
+static const double upload_budget = 0.002;
+
+// Texture memory kept by TextureManager
+static const size_t texture_budget = 256 * 1024 * 1024;
+
+// Texture filtering comes from sampler object, not from texture parameters
+static StateCache state_cache;
+static GLuint texture_sampler = 0;
+
+// (0.2, 0.3, 0.3), sRGB framebuffer takes its linear value (0.0331, 0.0732, 0.0732)
+static GLfloat clear_color[3] = { 0.2f, 0.3f, 0.3f };
+
+// Swap is left to caller, so GPU scopes can close before it
+static void draw_frame(GLuint texture_id)
+{
+    glClearColor(clear_color[0], clear_color[1], clear_color[2], 1.0f);
+    // Texture uploads bind through bind_texture_direct(), cache rebinds only after them
+    state_cache.bind_texture(0, GL_TEXTURE_2D, texture_id);
+    state_cache.bind_sampler(0, texture_sampler);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+static double seconds_since(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Time to first frame when textures are loaded before rendering and when
+// they are loaded by TextureLoader, shader program and vertex array must be bound
+static void run_texture_loading_benchmark(GLFWwindow* window, const char* path, size_t textures_count)
+{
+    glfwSwapInterval(0);
+    vector<GLuint> textures(textures_count);
+
+    // File is read once so all runs start with file in OS cache
+    GLuint warm_up_id = load_texture(path);
+    glDeleteTextures(1, &warm_up_id);
+
+    auto start = chrono::steady_clock::now();
+    for(GLuint& texture_id : textures)
+        texture_id = load_texture(path);
+    draw_frame(textures[0]);
+    glfwSwapBuffers(window);
+    glFinish();
+    const double sync_first_frame = seconds_since(start);
+    glDeleteTextures((GLsizei)textures.size(), textures.data());
+
+    cout << textures_count << " textures" << endl;
+    cout << "sync      : first frame " << sync_first_frame * 1000.0 << " ms" << endl;
+
+    PixelUploader uploader;
+    PixelUploader* uploaders[2] = { NULL, &uploader };
+    const char* names[2] = { "async     ", "async PBO " };
+    for(int u = 0; u < 2; ++u) {
+        start = chrono::steady_clock::now();
+        double first_frame = 0.0, max_frame_time = 0.0;
+        size_t frames = 0;
+        {
+            TextureLoader loader(0, uploaders[u]);
+            for(GLuint& texture_id : textures)
+                texture_id = loader.load(path);
+
+            do {
+                auto frame_start = chrono::steady_clock::now();
+                loader.update(upload_budget);
+                draw_frame(textures[frames % textures.size()]);
+                glfwSwapBuffers(window);
+                glFinish();
+                max_frame_time = max(max_frame_time, seconds_since(frame_start));
+                if(frames++ == 0)
+                    first_frame = seconds_since(start);
+            } while(loader.pending() > 0);
+        }
+        const double all_loaded = seconds_since(start);
+        glDeleteTextures((GLsizei)textures.size(), textures.data());
+
+        cout << names[u] << ": first frame " << first_frame * 1000.0 << " ms"
+             << ", all loaded " << all_loaded * 1000.0 << " ms in " << frames << " frames"
+             << ", max frame " << max_frame_time * 1000.0 << " ms" << endl;
+    }
+}
+
+// CPU mip chain (box and Kaiser, sRGB) against glGenerateMipmap on 4096x4096 RGBA texture
+static void run_mip_benchmark()
+{
+    const int size = 4096;
+    vector<unsigned char> pixels((size_t)size * size * 4);
+    for(size_t i = 0; i < pixels.size(); ++i)
+        pixels[i] = (unsigned char)((i * 7 + i / 16384 + rand() % 16) & 255);
+
+    GLuint texture_id, query_id;
+    glGenTextures(1, &texture_id);
+    glGenQueries(1, &query_id);
+    bind_texture_direct(GL_TEXTURE_2D, texture_id);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glFinish();
+
+    auto start = chrono::steady_clock::now();
+    glBeginQuery(GL_TIME_ELAPSED, query_id);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glEndQuery(GL_TIME_ELAPSED);
+    glFinish();
+    const double gpu_wall = seconds_since(start);
+    GLuint64 elapsed = 0;
+    glGetQueryObjectui64v(query_id, GL_QUERY_RESULT, &elapsed);
+    cout << "glGenerateMipmap        : " << gpu_wall * 1000.0 << " ms, GPU " << elapsed * 1e-6 << " ms" << endl;
+
+    const unsigned int threads = max(1u, thread::hardware_concurrency());
+    const char* names[2] = { "box   ", "kaiser" };
+    vector<MipLevel> mips;
+    for(int filter = 0; filter < 2; ++filter) {
+        for(unsigned int count : { 1u, threads }) {
+            start = chrono::steady_clock::now();
+            generate_mip_chain(pixels.data(), size, size, 4, true, (MipFilter)filter, mips, count);
+            cout << "CPU " << names[filter] << " " << count << " threads : " << seconds_since(start) * 1000.0 << " ms" << endl;
+        }
+    }
+
+    // CPU mips still have to reach GPU
+    start = chrono::steady_clock::now();
+    for(size_t level = 0; level < mips.size(); ++level)
+        glTexImage2D(GL_TEXTURE_2D, (GLint)level + 1, GL_RGBA8, mips[level].width, mips[level].height, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, mips[level].pixels.data());
+    glFinish();
+    cout << "CPU mips upload         : " << seconds_since(start) * 1000.0 << " ms" << endl;
+
+    glDeleteQueries(1, &query_id);
+    glDeleteTextures(1, &texture_id);
+}
+
+// Conversion kernels against per pixel loop and upload time of driver
+// preferred RGBA against RGB (converted by driver) on 4096x4096 image
+static void run_upload_benchmark()
+{
+    const int size = 4096;
+    const size_t pixels_count = (size_t)size * size;
+    vector<unsigned char> rgb(pixels_count * 3), rgba(pixels_count * 4);
+    for(size_t i = 0; i < rgb.size(); ++i)
+        rgb[i] = (unsigned char)((i * 7 + i / 16384 + rand() % 16) & 255);
+
+    const int repeats = 5;
+    auto best_of = [&](auto&& run) {
+        double best = 1e9;
+        for(int r = 0; r < repeats; ++r) {
+            auto start = chrono::steady_clock::now();
+            run();
+            best = min(best, seconds_since(start));
+        }
+        return best;
+    };
+    auto report = [&](const char* name, double seconds, size_t bytes) {
+        cout << name << " : " << seconds * 1000.0 << " ms, " << bytes / seconds / (1024.0 * 1024.0) << " MB/s" << endl;
+    };
+
+    report("RGB -> RGBA loop   ", best_of([&] {
+        for(size_t i = 0; i < pixels_count; ++i) {
+            rgba[i * 4] = rgb[i * 3];
+            rgba[i * 4 + 1] = rgb[i * 3 + 1];
+            rgba[i * 4 + 2] = rgb[i * 3 + 2];
+            rgba[i * 4 + 3] = 255;
+        }
+    }), rgb.size());
+    report("RGB -> RGBA        ", best_of([&] { convert_rgb_to_rgba(rgb.data(), rgba.data(), pixels_count); }), rgb.size());
+    report("BGR -> RGBA        ", best_of([&] { convert_bgr_to_rgba(rgb.data(), rgba.data(), pixels_count); }), rgb.size());
+    report("BGRA -> RGBA       ", best_of([&] { swizzle_bgra_to_rgba(rgba.data(), rgba.data(), pixels_count); }), rgba.size());
+    vector<unsigned char> premultiplied(rgba);
+    report("premultiply alpha  ", best_of([&] { premultiply_alpha(premultiplied.data(), pixels_count); }), rgba.size());
+    convert_rgb_to_rgba(rgb.data(), rgba.data(), pixels_count);
+
+    struct Upload {
+        const char* name;
+        GLint       internal_format;
+        GLenum      format;
+        GLenum      type;
+        const void* pixels;
+        size_t      row_bytes;
+    } uploads[] = {
+        { "GL_RGB8 from RGB   ", GL_RGB8, GL_RGB, GL_UNSIGNED_BYTE, rgb.data(), (size_t)size * 3 },
+        { "GL_RGBA8 from RGBA ", GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data(), (size_t)size * 4 },
+        { "GL_RGBA8 from BGRA ", GL_RGBA8, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, rgba.data(), (size_t)size * 4 },
+        { "GL_SRGB8_ALPHA8    ", color_internal_format(4, true), GL_RGBA, GL_UNSIGNED_BYTE, rgba.data(), (size_t)size * 4 },
+    };
+
+    GLuint texture_id;
+    glGenTextures(1, &texture_id);
+    bind_texture_direct(GL_TEXTURE_2D, texture_id);
+    for(const Upload& upload : uploads) {
+        glTexImage2D(GL_TEXTURE_2D, 0, upload.internal_format, size, size, 0, upload.format, upload.type, NULL);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, unpack_alignment(upload.row_bytes));
+        report(upload.name, best_of([&] {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size, size, upload.format, upload.type, upload.pixels);
+            glFinish();
+        }), upload.row_bytes * size);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glDeleteTextures(1, &texture_id);
+}
+
+// Sprites from one atlas in single draw call against texture per image,
+// which needs bind and draw call per sprite
+static void run_sprite_benchmark(GLFWwindow* window, size_t sprites_count)
+{
+    glfwSwapInterval(0);
+    int width, height;
+    glfwGetFramebufferSize(window, &width, &height);
+
+    const int images_count = 256;
+    vector<vector<unsigned char>> images(images_count);
+    vector<int> sizes(images_count * 2);
+    for(int i = 0; i < images_count; ++i) {
+        sizes[i * 2] = 16 + rand() % 49;
+        sizes[i * 2 + 1] = 16 + rand() % 49;
+        images[i].resize((size_t)sizes[i * 2] * sizes[i * 2 + 1] * 4);
+        for(size_t p = 0; p < images[i].size(); ++p)
+            images[i][p] = p % 4 == 3 ? 255 : (unsigned char)((p / 4 % sizes[i * 2]) * 4 + i * 37 + p % 4 * 80);
+    }
+
+    auto start = chrono::steady_clock::now();
+    TextureAtlas atlas;
+    for(int i = 0; i < images_count; ++i)
+        atlas.add(images[i].data(), sizes[i * 2], sizes[i * 2 + 1]);
+    atlas.build();
+    cout << images_count << " images packed into " << atlas.layers() << " atlas layers in "
+         << seconds_since(start) * 1000.0 << " ms" << endl;
+
+    // Atlas of single image is texture per image
+    vector<unique_ptr<TextureAtlas>> separate;
+    for(int i = 0; i < images_count; ++i) {
+        separate.emplace_back(new TextureAtlas(128));
+        separate.back()->add(images[i].data(), sizes[i * 2], sizes[i * 2 + 1]);
+        separate.back()->build();
+    }
+
+    SpriteBatch batch;
+    if(!batch.valid())
+        return;
+
+    const int frames = 100;
+    const char* names[2] = { "texture per image", "atlas            " };
+    for(int mode = 0; mode < 2; ++mode) {
+        size_t draw_calls = 0;
+        start = chrono::steady_clock::now();
+        for(int frame = 0; frame < frames; ++frame) {
+            glClear(GL_COLOR_BUFFER_BIT);
+            batch.begin(width, height);
+            for(size_t i = 0; i < sprites_count; ++i) {
+                const int image = (int)(i % images_count);
+                const float x = (float)((i * 7919) % width), y = (float)((i * 104729) % height);
+                if(mode == 0)
+                    batch.draw(*separate[image], 0, x, y, (float)sizes[image * 2], (float)sizes[image * 2 + 1]);
+                else
+                    batch.draw(atlas, image, x, y, (float)sizes[image * 2], (float)sizes[image * 2 + 1]);
+            }
+            batch.end();
+            draw_calls = batch.draw_calls();
+            glfwSwapBuffers(window);
+        }
+        glFinish();
+        cout << names[mode] << " : " << sprites_count << " sprites, " << draw_calls << " draw calls, "
+             << seconds_since(start) * 1000.0 / frames << " ms per frame" << endl;
+    }
+}
+
+// Textures used through sliding window over more textures than budget
+// holds, shows cost of evictions, downgrades and reloads
+static void run_residency_benchmark(GLFWwindow* window, const char* path, size_t budget_bytes)
+{
+    glfwSwapInterval(0);
+    const size_t textures_count = 32, window_size = 8;
+    const int frames = 600;
+
+    PixelUploader uploader;
+    TextureLoader loader(0, &uploader);
+    TextureManager manager(loader, budget_bytes);
+
+    // Same file under different paths, so each is its own texture
+    vector<TextureHandle> handles;
+    string unique_path = path;
+    for(size_t i = 0; i < textures_count; ++i) {
+        handles.push_back(manager.add(unique_path.c_str()));
+        unique_path = "./" + unique_path;
+    }
+
+    double max_frame_time = 0.0, total_time = 0.0;
+    size_t max_usage = 0;
+    for(int frame = 0; frame < frames; ++frame) {
+        auto frame_start = chrono::steady_clock::now();
+        const size_t first = (size_t)frame / 10 % textures_count;
+        GLuint texture_id = 0;
+        for(size_t i = 0; i < window_size; ++i)
+            texture_id = manager.use(handles[(first + i) % textures_count]);
+        manager.update(upload_budget);
+        draw_frame(texture_id);
+        glfwSwapBuffers(window);
+        glFinish();
+        const double frame_time = seconds_since(frame_start);
+        max_frame_time = max(max_frame_time, frame_time);
+        total_time += frame_time;
+        max_usage = max(max_usage, manager.usage());
+    }
+
+    cout << textures_count << " textures, " << window_size << " used per frame, budget "
+         << budget_bytes / (1024 * 1024) << " MB" << endl;
+    cout << "usage " << manager.usage() / (1024 * 1024) << " MB (max " << max_usage / (1024 * 1024) << " MB)"
+         << ", evictions " << manager.evictions() << ", downgrades " << manager.downgrades()
+         << ", reloads " << manager.reloads() << endl;
+    cout << "frame average " << total_time * 1000.0 / frames << " ms, max " << max_frame_time * 1000.0 << " ms" << endl;
+}
+
+// On-screen size of textures grows from 16 pixels to 1024 and drops back
+// to 64, streamer follows it within per frame upload budget
+static void run_streaming_benchmark(GLFWwindow* window, const char* path)
+{
+    glfwSwapInterval(0);
+    const size_t textures_count = 16;
+    const int grow_frames = 200, frames = 300;
+
+    TextureStreamer streamer;
+    vector<size_t> textures;
+    string unique_path = path;
+    for(size_t i = 0; i < textures_count; ++i) {
+        textures.push_back(streamer.add(unique_path.c_str()));
+        unique_path = "./" + unique_path;
+    }
+
+    auto start = chrono::steady_clock::now();
+    double max_frame_time = 0.0;
+    size_t max_frame_bytes = 0, peak_bytes = 0;
+    for(int frame = 0; frame < frames; ++frame) {
+        auto frame_start = chrono::steady_clock::now();
+        const float screen_size = frame < grow_frames ? 16.0f * pow(64.0f, (float)frame / grow_frames) : 64.0f;
+        for(size_t texture : textures)
+            streamer.request(texture, screen_size);
+        max_frame_bytes = max(max_frame_bytes, streamer.update());
+        draw_frame(streamer.texture(textures[frame % textures_count]));
+        glfwSwapBuffers(window);
+        glFinish();
+        max_frame_time = max(max_frame_time, seconds_since(frame_start));
+        peak_bytes = max(peak_bytes, streamer.resident_bytes());
+        if(frame == grow_frames - 1)
+            cout << "grown to " << screen_size << " pixels : " << streamer.streaming() << " textures streaming, "
+                 << streamer.resident_bytes() / 1024 << " KB resident" << endl;
+    }
+
+    cout << textures_count << " textures, " << frames << " frames in " << seconds_since(start) * 1000.0 << " ms" << endl;
+    cout << "max frame " << max_frame_time * 1000.0 << " ms, max upload " << max_frame_bytes / 1024 << " KB per frame" << endl;
+    cout << "resident peak " << peak_bytes / 1024 << " KB, after shrinking " << streamer.resident_bytes() / 1024 << " KB" << endl;
+}
+
+// Ground plane receding to horizon, far edge has w = 16, so texture is
+// sampled at strongly anisotropic footprints towards top of screen
+static const char* plane_vertex_shader_text =
+"#version 330 core\n"
+"out vec2 textureCoord;\n"
+"void main()\n"
+"{\n"
+"    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);\n"
+"    float w = mix(1.0, 16.0, corner.y);\n"
+"    gl_Position = vec4((corner * 2.0 - 1.0) * w, 0.0, w);\n"
+"    textureCoord = corner * vec2(8.0, 64.0);\n"
+"}";
+
+static const char* plane_fragment_shader_text =
+"#version 330 core\n"
+"in vec2 textureCoord;\n"
+"out vec4 color;\n"
+"uniform sampler2D image;\n"
+"void main()\n"
+"{\n"
+"    color = texture(image, textureCoord);\n"
+"}\n";
+
+static GLuint create_program(const char* vertex_text, const char* fragment_text)
+{
+    TRACE_SCOPE("compile shaders");
+    GLuint shaders[2] = { glCreateShader(GL_VERTEX_SHADER), glCreateShader(GL_FRAGMENT_SHADER) };
+    const char* texts[2] = { vertex_text, fragment_text };
+    GLuint program_id = glCreateProgram();
+    for(int i = 0; i < 2; ++i) {
+        glShaderSource(shaders[i], 1, &texts[i], NULL);
+        glCompileShader(shaders[i]);
+        glAttachShader(program_id, shaders[i]);
+    }
+    glLinkProgram(program_id);
+    glDeleteShader(shaders[0]);
+    glDeleteShader(shaders[1]);
+
+    GLint status;
+    glGetProgramiv(program_id, GL_LINK_STATUS, &status);
+    if(status != GL_TRUE) {
+        cerr << "Error : failed to create shader program" << endl;
+        glDeleteProgram(program_id);
+        return 0;
+    }
+    return program_id;
+}
+
+// GPU time of full screen plane with bilinear, trilinear and anisotropic samplers
+static void run_sampler_benchmark(const char* path, SamplerCache& samplers)
+{
+    GLuint program_id = create_program(plane_vertex_shader_text, plane_fragment_shader_text);
+    GLuint texture_id = load_texture(path);
+    if(!program_id || !texture_id)
+        return;
+
+    struct Mode {
+        const char* name;
+        SamplerDesc desc;
+    } modes[] = {
+        { "bilinear         ", { GL_LINEAR, GL_LINEAR, GL_REPEAT, GL_REPEAT, 1.0f, 0.0f } },
+        { "trilinear        ", trilinear_sampler() },
+        { "trilinear bias -1", { GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, GL_REPEAT, GL_REPEAT, 1.0f, -1.0f } },
+        { "anisotropic 2x   ", anisotropic_sampler(2.0f) },
+        { "anisotropic 4x   ", anisotropic_sampler(4.0f) },
+        { "anisotropic 8x   ", anisotropic_sampler(8.0f) },
+        { "anisotropic 16x  ", anisotropic_sampler(16.0f) },
+    };
+
+    cout << "Max anisotropy : " << gl_extensions.max_anisotropy << endl;
+    GLuint query_id;
+    glGenQueries(1, &query_id);
+    const int passes = 100;
+    state_cache.invalidate();
+    state_cache.use_program(program_id);
+    state_cache.bind_texture(0, GL_TEXTURE_2D, texture_id);
+    for(const Mode& mode : modes) {
+        state_cache.bind_sampler(0, samplers.get(mode.desc));
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        glFinish();
+
+        glBeginQuery(GL_TIME_ELAPSED, query_id);
+        for(int pass = 0; pass < passes; ++pass) {
+            state_cache.bind_texture(0, GL_TEXTURE_2D, texture_id);
+            state_cache.bind_sampler(0, samplers.get(mode.desc));
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        }
+        glEndQuery(GL_TIME_ELAPSED);
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(query_id, GL_QUERY_RESULT, &elapsed);
+        cout << mode.name << " : " << elapsed * 1e-6 / passes << " ms per full screen pass" << endl;
+    }
+    cout << samplers.size() << " sampler objects, " << state_cache.calls() << " binds issued, "
+         << state_cache.skipped() << " redundant binds skipped" << endl;
+
+    glDeleteQueries(1, &query_id);
+    glDeleteTextures(1, &texture_id);
+    glDeleteProgram(program_id);
+}
+
 int main(int argc, char** argv)
 {
     cout << "Application started..." << endl;
+
+    // Vertex format benchmark : --vertex-bench [vertices count]
+    // Texture loading benchmark : --texture-bench [textures count]
+    // Mip generation benchmark : --mip-bench
+    // Pixel conversion and upload benchmark : --upload-bench
+    // Sprite batching benchmark : --sprite-bench [sprites count]
+    // Texture residency benchmark : --residency-bench [budget MB]
+    // Mip streaming benchmark : --stream-bench
+    // Sampler filtering benchmark : --sampler-bench
+    // Texture filtering : --anisotropy N (1 is trilinear, default 8)
+    // Frame pacing : --vsync off|on|adaptive, --fps N, --on-demand, --pacing-report
+    // GPU scope timings : --gpu-profile
+    // CPU and GPU timeline in Chrome trace format : --trace [file]
+    // GL call statistics (debug builds) : --gl-calls
+    FramePacingConfig pacing = default_frame_pacing();
+    bool gpu_profile = false;
+    const char* trace_path = NULL;
+    bool gl_calls = false;
+    size_t benchmark_vertices = 0;
+    size_t benchmark_textures = 0;
+    bool benchmark_mips = false;
+    bool benchmark_uploads = false;
+    size_t benchmark_sprites = 0;
+    size_t benchmark_residency = 0;
+    bool benchmark_streaming = false;
+    bool benchmark_samplers = false;
+    float anisotropy = 8.0f;
+    for(int i = 1; i < argc; ++i) {
+        if(strcmp(argv[i], "--vertex-bench") == 0) {
+            benchmark_vertices = 3000000;
+            if(i + 1 < argc && atol(argv[i + 1]) > 0)
+                benchmark_vertices = atol(argv[++i]);
+        } else if(strcmp(argv[i], "--texture-bench") == 0) {
+            benchmark_textures = 100;
+            if(i + 1 < argc && atol(argv[i + 1]) > 0)
+                benchmark_textures = atol(argv[++i]);
+        } else if(strcmp(argv[i], "--mip-bench") == 0) {
+            benchmark_mips = true;
+        } else if(strcmp(argv[i], "--upload-bench") == 0) {
+            benchmark_uploads = true;
+        } else if(strcmp(argv[i], "--sprite-bench") == 0) {
+            benchmark_sprites = 10000;
+            if(i + 1 < argc && atol(argv[i + 1]) > 0)
+                benchmark_sprites = atol(argv[++i]);
+        } else if(strcmp(argv[i], "--residency-bench") == 0) {
+            benchmark_residency = 16;
+            if(i + 1 < argc && atol(argv[i + 1]) > 0)
+                benchmark_residency = atol(argv[++i]);
+        } else if(strcmp(argv[i], "--stream-bench") == 0) {
+            benchmark_streaming = true;
+        } else if(strcmp(argv[i], "--sampler-bench") == 0) {
+            benchmark_samplers = true;
+        } else if(strcmp(argv[i], "--anisotropy") == 0 && i + 1 < argc) {
+            const float value = (float)atof(argv[++i]);
+            if(value >= 1.0f)
+                anisotropy = value;
+            else
+                cerr << "Error : anisotropy must be 1 or more, got " << argv[i] << endl;
+        } else if(strcmp(argv[i], "--gpu-profile") == 0) {
+            gpu_profile = true;
+        } else if(strcmp(argv[i], "--gl-calls") == 0) {
+            gl_calls = true;
+        } else if(strcmp(argv[i], "--trace") == 0) {
+            trace_path = "trace.json";
+            if(i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0)
+                trace_path = argv[++i];
+        } else {
+            parse_frame_pacing_arg(i, argc, argv, pacing);
+        }
+    }
+
+    // Loader threads name their tracks on start, so tracing starts first
+    if(trace_path) {
+        trace_start();
+        trace_thread_name("main");
+    }
+
     if (!glfwInit())
         exit(EXIT_FAILURE);
 
@@ -75,6 +732,7 @@ int main(int argc, char** argv)
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
+    glfwWindowHint(GLFW_SRGB_CAPABLE, GL_TRUE);
 
     // Create main window
     GLFWwindow* window = glfwCreateWindow(640, 480, "OpenGL", NULL, NULL);
@@ -89,35 +747,52 @@ int main(int argc, char** argv)
 
     // Initialize OpenGL
     gladLoadGL(glfwGetProcAddress);
+    load_gl_extensions();
+
+    if(gl_calls && !install_gl_call_stats())
+        cerr << "Error : GL call statistics are compiled in debug builds only" << endl;
+    if(trace_path) {
+        GLint64 gpu_time = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpu_time);
+        trace_sync_gpu_clock(gpu_time);
+    }
 
     int width, height;
     glfwGetFramebufferSize(window, &width, &height);
     glViewport(0, 0, width, height);
+    // sRGB capable framebuffer is only a hint. When granted, textures are sampled
+    // as linear values and encoded back to sRGB on write, otherwise sRGB values
+    // go through unchanged and textures are not tagged sRGB.
+    GLint color_encoding = GL_LINEAR;
+    glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, GL_BACK_LEFT, GL_FRAMEBUFFER_ATTACHMENT_COLOR_ENCODING,
+                                          &color_encoding);
+    set_srgb_color_textures(color_encoding == GL_SRGB);
+    if(color_encoding == GL_SRGB) {
+        glEnable(GL_FRAMEBUFFER_SRGB);
+        clear_color[0] = 0.0331f;
+        clear_color[1] = 0.0732f;
+        clear_color[2] = 0.0732f;
+    }
+    cout << "Framebuffer : " << (color_encoding == GL_SRGB ? "sRGB" : "linear") << endl;
 
-    // Create texture from image file
-    int texture_width = 0, texture_height = 0;
-    unsigned char* image = SOIL_load_image("./stones.jpg", &texture_width, &texture_height, 0, SOIL_LOAD_RGB);
-    cout << "Texture size : " << texture_width << "x" << texture_height << endl;
-
-    GLuint textureId;
-    glGenTextures(1, &textureId);
-    glBindTexture(GL_TEXTURE_2D, textureId);
-    glTexImage2D(
-        GL_TEXTURE_2D,      // Texture target
-        0,                  // Mipmap level
-        GL_RGB,             // Texture store format
-        texture_width,      // Pixels array size
-        texture_height,     //
-        0,                  // Old parameters, always must be 0
-        GL_RGB,             // Source image pixels array format
-        GL_UNSIGNED_BYTE,   //
-        image               // Pixels color data array
-    );
-    glGenerateMipmap(GL_TEXTURE_2D);
+    // Texture cooked by TextureCooker is preferred over source image
+    FILE* cooked_texture = fopen("./stones.dds", "rb");
+    const char* texture_path = cooked_texture ? "./stones.dds" : "./stones.jpg";
+    if(cooked_texture)
+        fclose(cooked_texture);
+    cout << "Texture : " << texture_path << endl;
+
+    // Texture is decoded in background, placeholder is drawn until upload
+    PixelUploader pixel_uploader;
+    TextureLoader texture_loader(0, &pixel_uploader);
+    TextureManager texture_manager(texture_loader, texture_budget);
+    TextureHandle texture = texture_manager.add(texture_path);
 
-    // Free image resources
-    SOIL_free_image_data(image);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    // Same sampler serves every texture with the same filtering,
+    // anisotropy above hardware limit is clamped by cache
+    SamplerCache samplers;
+    texture_sampler = samplers.get(anisotropy > 1.0f ? anisotropic_sampler(anisotropy) : trilinear_sampler());
+    cout << "Anisotropy : " << min(anisotropy, gl_extensions.max_anisotropy) << endl;
 
 
     // Create buffers
@@ -125,7 +800,10 @@ int main(int argc, char** argv)
     glGenVertexArrays(1, &vao_id);
     glGenBuffers(1, &vbo_id);
     glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    const VertexFormat vertex_format = compact_vertex_format();
+    vector<unsigned char> packed_vertices;
+    pack_vertices(vertex_format, vertices, sizeof(vertices) / sizeof(vertices[0]) / source_vertex_size, packed_vertices);
+    glBufferData(GL_ARRAY_BUFFER, packed_vertices.size(), packed_vertices.data(), GL_STATIC_DRAW);
 
     // Create shader program
     const unsigned int max_log_length = 512;
@@ -135,8 +813,12 @@ int main(int argc, char** argv)
     cout << "Creating vertex shader..." << endl;
     GLuint vertex_shader_id = glCreateShader(GL_VERTEX_SHADER);
     glShaderSource(vertex_shader_id, 1, &vertex_shader_text, NULL);
-    glCompileShader(vertex_shader_id);
-    glGetShaderiv(vertex_shader_id, GL_COMPILE_STATUS, &status);
+    {
+        // Status query waits for compilation, which may be deferred by driver
+        TRACE_SCOPE("compile vertex shader");
+        glCompileShader(vertex_shader_id);
+        glGetShaderiv(vertex_shader_id, GL_COMPILE_STATUS, &status);
+    }
 
     if(status != GL_TRUE) {
         glGetShaderInfoLog(vertex_shader_id, max_log_length, NULL, info_log);
@@ -149,8 +831,11 @@ int main(int argc, char** argv)
     cout << "Crating fragment shader..." << endl;
     GLuint fragment_shader_id = glCreateShader(GL_FRAGMENT_SHADER);
     glShaderSource(fragment_shader_id, 1, &fragment_shader_text, NULL);
-    glCompileShader(fragment_shader_id);
-    glGetShaderiv(fragment_shader_id, GL_COMPILE_STATUS, &status);
+    {
+        TRACE_SCOPE("compile fragment shader");
+        glCompileShader(fragment_shader_id);
+        glGetShaderiv(fragment_shader_id, GL_COMPILE_STATUS, &status);
+    }
 
     if(status != GL_TRUE) {
         glGetShaderInfoLog(fragment_shader_id, max_log_length, NULL, info_log);
@@ -164,8 +849,11 @@ int main(int argc, char** argv)
     GLuint shader_program_id = glCreateProgram();
     glAttachShader(shader_program_id, vertex_shader_id);
     glAttachShader(shader_program_id, fragment_shader_id);
-    glLinkProgram(shader_program_id);
-    glGetProgramiv(shader_program_id, GL_LINK_STATUS, &status);
+    {
+        TRACE_SCOPE("link program");
+        glLinkProgram(shader_program_id);
+        glGetProgramiv(shader_program_id, GL_LINK_STATUS, &status);
+    }
 
     if(status != GL_TRUE) {
         glGetProgramInfoLog(shader_program_id, max_log_length, NULL, info_log);
@@ -181,62 +869,115 @@ int main(int argc, char** argv)
     glDeleteShader(vertex_shader_id);
     glDeleteShader(fragment_shader_id);
 
-    // Data array - vertices
-    //  _______________________________________________________________
-    // |            Vertex 1           |            Vertex 2           |
-    // |___________|___________|_______|___________|___________|_______|
-    // | X | Y | Z | R | G | B | S | T | X | Y | Z | R | G | B | S | T |
-    // |___|___|___|___|___|___|___|___|___|___|___|___|___|___|___|___|
-    // | 0 | 1 | 3 | 4 | 5 | 6 | 7 | 8 | 9 | 0 | 1 | 2 | 3 | 4 | 5 | 6 |
-    //
-    //  <-----------------------------> <----------------------------->
-    //      step = 8 * sizeof(float)
     glBindVertexArray(vao_id);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(
-        0,                             // Input layout position in vertex shader
-        3,                             // Input vector size
-        GL_FLOAT,                      // Data type
-        GL_FALSE,                      // No need to normalize data
-        8 * sizeof(GL_FLOAT),          // Data step
-        (GLvoid*)0                     // Start data offset
-    );
-
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(
-        1,                             // Input layout position in vertex shader
-        3,                             // Input vector size
-        GL_FLOAT,                      // Data type
-        GL_FALSE,                      // No need to normalize data
-        8 * sizeof(GL_FLOAT),          // Data step
-        (GLvoid*)(3 * sizeof(GLfloat)) // Start data offset
-    );
-
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(
-        2,                             // Input layout position in vertex shader
-        2,                             // Input vector size
-        GL_FLOAT,                      // Data type
-        GL_FALSE,                      // No need to normalize data
-        8 * sizeof(GL_FLOAT),          // Data step
-        (GLvoid*)(6 * sizeof(GLfloat)) // Start data offset
-    );
-
-
-    // Main loop
+    vertex_format.apply();
+
+    if(benchmark_vertices > 0) {
+        bind_texture_direct(GL_TEXTURE_2D, texture_manager.use(texture));
+        run_vertex_format_benchmark(benchmark_vertices);
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        exit(EXIT_SUCCESS);
+    }
+
+    if(benchmark_mips) {
+        run_mip_benchmark();
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        exit(EXIT_SUCCESS);
+    }
+
+    if(benchmark_uploads) {
+        run_upload_benchmark();
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        exit(EXIT_SUCCESS);
+    }
+
+    if(benchmark_sprites > 0) {
+        run_sprite_benchmark(window, benchmark_sprites);
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        exit(EXIT_SUCCESS);
+    }
+
+    if(benchmark_residency > 0) {
+        run_residency_benchmark(window, texture_path, benchmark_residency * 1024 * 1024);
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        exit(EXIT_SUCCESS);
+    }
+
+    if(benchmark_streaming) {
+        run_streaming_benchmark(window, texture_path);
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        exit(EXIT_SUCCESS);
+    }
+
+    if(benchmark_samplers) {
+        run_sampler_benchmark(texture_path, samplers);
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        exit(EXIT_SUCCESS);
+    }
+
+    if(benchmark_textures > 0) {
+        run_texture_loading_benchmark(window, texture_path, benchmark_textures);
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        exit(EXIT_SUCCESS);
+    }
+
+
+    // Main loop, on demand it keeps redrawing only while textures are loading
+    FramePacer pacer(pacing);
+    // Trace needs GPU spans, so it turns profiler on too
+    GpuProfiler gpu_profiler(gpu_profile || trace_path);
+    double profile_report_time = glfwGetTime();
     while (!glfwWindowShouldClose(window))
     {
-        glfwPollEvents();
-
-        // Render
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glBindTexture(GL_TEXTURE_2D, textureId);
-        glClear(GL_COLOR_BUFFER_BIT);
-        glDrawArrays(GL_TRIANGLES, 0, 3);
+        TRACE_SCOPE("frame");
+        {
+            TRACE_SCOPE("poll events");
+            pacer.wait_events(texture_loader.pending() > 0);
+        }
+        if(gpu_profiler.begin_frame() && trace_path) {
+            for(const GpuProfiler::Span& span : gpu_profiler.last_spans())
+                trace_gpu_span(span.name, span.begin, span.end);
+        }
+        {
+            GpuScope frame_scope(gpu_profiler, "frame");
+            GLuint texture_id;
+            {
+                TRACE_SCOPE("update");
+                GpuScope upload_scope(gpu_profiler, "texture uploads");
+                texture_id = texture_manager.use(texture);
+                texture_manager.update(upload_budget);
+            }
+
+            // Render
+            TRACE_SCOPE("render");
+            GpuScope draw_scope(gpu_profiler, "draw");
+            draw_frame(texture_id);
+        }
+        gpu_profiler.end_frame();
+        gl_call_stats_end_frame();
+        {
+            TRACE_SCOPE("swap");
+            glfwSwapBuffers(window);
+        }
+        pacer.end_frame();
 
-        glfwSwapBuffers(window);
+        if(gpu_profiler.is_enabled() && glfwGetTime() - profile_report_time >= 2.0) {
+            gpu_profiler.print(cout);
+            profile_report_time = glfwGetTime();
+        }
     }
 
+    if(trace_path)
+        trace_write(trace_path);
+
     // Shutdown
     glfwDestroyWindow(window);
     glfwTerminate();
@@ -0,0 +1,174 @@
+#include <block_compression.h>
+#include <algorithm>  // min, max
+#include <cmath>      // abs
+#include <cstring>    // memcpy
+
+size_t block_size(BlockFormat format) {
+    return format == BLOCK_BC1 ? 8 : 16;
+}
+
+size_t compressed_size(BlockFormat format, int width, int height) {
+    const size_t blocks_x = std::max(1, (width + 3) / 4);
+    const size_t blocks_y = std::max(1, (height + 3) / 4);
+    return blocks_x * blocks_y * block_size(format);
+}
+
+static inline uint16_t pack_565(const int* rgb) {
+    return (uint16_t)(((rgb[0] * 31 + 127) / 255) << 11 | ((rgb[1] * 63 + 127) / 255) << 5 | ((rgb[2] * 31 + 127) / 255));
+}
+
+static inline void unpack_565(uint16_t color, int* rgb) {
+    const int r = color >> 11, g = (color >> 5) & 63, b = color & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+// Color part of BC1/BC3 block, always 4 color mode (color0 > color1)
+static void compress_color_block(const uint8_t* rgba, uint8_t* destination) {
+    // Mean and covariance of block colors
+    float mean[3] = { 0.0f, 0.0f, 0.0f };
+    for(int i = 0; i < 16; ++i)
+        for(int c = 0; c < 3; ++c)
+            mean[c] += rgba[i * 4 + c];
+    for(int c = 0; c < 3; ++c)
+        mean[c] /= 16.0f;
+
+    float covariance[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    for(int i = 0; i < 16; ++i) {
+        const float r = rgba[i * 4] - mean[0], g = rgba[i * 4 + 1] - mean[1], b = rgba[i * 4 + 2] - mean[2];
+        covariance[0] += r * r; covariance[1] += r * g; covariance[2] += r * b;
+        covariance[3] += g * g; covariance[4] += g * b; covariance[5] += b * b;
+    }
+
+    // Principal axis by power iteration
+    float axis[3] = { 1.0f, 1.0f, 1.0f };
+    for(int iteration = 0; iteration < 4; ++iteration) {
+        const float x = axis[0] * covariance[0] + axis[1] * covariance[1] + axis[2] * covariance[2];
+        const float y = axis[0] * covariance[1] + axis[1] * covariance[3] + axis[2] * covariance[4];
+        const float z = axis[0] * covariance[2] + axis[1] * covariance[4] + axis[2] * covariance[5];
+        const float length = std::max(std::max(std::abs(x), std::abs(y)), std::abs(z));
+        if(length < 1e-6f)
+            break;
+        axis[0] = x / length; axis[1] = y / length; axis[2] = z / length;
+    }
+
+    // Extreme colors along axis
+    int min_index = 0, max_index = 0;
+    float min_projection = 1e30f, max_projection = -1e30f;
+    for(int i = 0; i < 16; ++i) {
+        const float projection = rgba[i * 4] * axis[0] + rgba[i * 4 + 1] * axis[1] + rgba[i * 4 + 2] * axis[2];
+        if(projection < min_projection) { min_projection = projection; min_index = i; }
+        if(projection > max_projection) { max_projection = projection; max_index = i; }
+    }
+
+    // Inset by 1/16 of range, interpolated colors then cover extremes better
+    int high[3], low[3];
+    for(int c = 0; c < 3; ++c) {
+        const int a = rgba[max_index * 4 + c], b = rgba[min_index * 4 + c];
+        const int inset = (a - b) / 16;
+        high[c] = std::min(255, std::max(0, a - inset));
+        low[c] = std::min(255, std::max(0, b + inset));
+    }
+
+    uint16_t color0 = pack_565(high), color1 = pack_565(low);
+    if(color0 < color1)
+        std::swap(color0, color1);
+
+    uint32_t indices = 0;
+    if(color0 != color1) {
+        int palette[4][3];
+        unpack_565(color0, palette[0]);
+        unpack_565(color1, palette[1]);
+        for(int c = 0; c < 3; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for(int i = 0; i < 16; ++i) {
+            int best = 0, best_distance = 1 << 30;
+            for(int p = 0; p < 4; ++p) {
+                const int dr = rgba[i * 4] - palette[p][0];
+                const int dg = rgba[i * 4 + 1] - palette[p][1];
+                const int db = rgba[i * 4 + 2] - palette[p][2];
+                const int distance = dr * dr + dg * dg + db * db;
+                if(distance < best_distance) {
+                    best_distance = distance;
+                    best = p;
+                }
+            }
+            indices |= (uint32_t)best << (i * 2);
+        }
+    }
+
+    destination[0] = color0 & 0xff;
+    destination[1] = color0 >> 8;
+    destination[2] = color1 & 0xff;
+    destination[3] = color1 >> 8;
+    for(int i = 0; i < 4; ++i)
+        destination[4 + i] = (indices >> (i * 8)) & 0xff;
+}
+
+// BC3 alpha block : two 8 bit endpoints and 3 bit indices, 8 value mode
+static void compress_alpha_block(const uint8_t* rgba, uint8_t* destination) {
+    int alpha0 = 0, alpha1 = 255;
+    for(int i = 0; i < 16; ++i) {
+        alpha0 = std::max(alpha0, (int)rgba[i * 4 + 3]);
+        alpha1 = std::min(alpha1, (int)rgba[i * 4 + 3]);
+    }
+
+    uint64_t indices = 0;
+    if(alpha0 > alpha1) {
+        int palette[8] = { alpha0, alpha1 };
+        for(int p = 1; p < 7; ++p)
+            palette[p + 1] = ((7 - p) * alpha0 + p * alpha1) / 7;
+
+        for(int i = 0; i < 16; ++i) {
+            int best = 0, best_distance = 256;
+            for(int p = 0; p < 8; ++p) {
+                const int distance = std::abs(rgba[i * 4 + 3] - palette[p]);
+                if(distance < best_distance) {
+                    best_distance = distance;
+                    best = p;
+                }
+            }
+            indices |= (uint64_t)best << (i * 3);
+        }
+    }
+
+    destination[0] = (uint8_t)alpha0;
+    destination[1] = (uint8_t)alpha1;
+    for(int i = 0; i < 6; ++i)
+        destination[2 + i] = (indices >> (i * 8)) & 0xff;
+}
+
+void compress_bc1_block(const uint8_t* rgba, uint8_t* destination) {
+    compress_color_block(rgba, destination);
+}
+
+void compress_bc3_block(const uint8_t* rgba, uint8_t* destination) {
+    compress_alpha_block(rgba, destination);
+    compress_color_block(rgba, destination + 8);
+}
+
+void compress_image(BlockFormat format, const uint8_t* rgba, int width, int height, uint8_t* destination) {
+    uint8_t block[16 * 4];
+    const size_t size = block_size(format);
+    for(int y = 0; y < height; y += 4) {
+        for(int x = 0; x < width; x += 4) {
+            for(int row = 0; row < 4; ++row) {
+                const int source_y = std::min(y + row, height - 1);
+                for(int column = 0; column < 4; ++column) {
+                    const int source_x = std::min(x + column, width - 1);
+                    memcpy(&block[(row * 4 + column) * 4], &rgba[((size_t)source_y * width + source_x) * 4], 4);
+                }
+            }
+
+            if(format == BLOCK_BC1)
+                compress_bc1_block(block, destination);
+            else
+                compress_bc3_block(block, destination);
+            destination += size;
+        }
+    }
+}
@@ -0,0 +1,160 @@
+#include <dds_texture.h>
+#include <algorithm>  // max
+#include <cstdio>     // fopen
+#include <cstring>    // memcpy, memset
+#include <iostream>   // cerr
+
+// DDS layout (little endian) : "DDS " magic, 124 byte header, level data
+struct DdsPixelFormat {
+    uint32_t size;
+    uint32_t flags;
+    uint32_t four_cc;
+    uint32_t rgb_bit_count;
+    uint32_t masks[4];
+};
+
+struct DdsHeader {
+    uint32_t       size;
+    uint32_t       flags;
+    uint32_t       height;
+    uint32_t       width;
+    uint32_t       pitch_or_linear_size;
+    uint32_t       depth;
+    uint32_t       mip_map_count;
+    uint32_t       reserved1[11];
+    DdsPixelFormat pixel_format;
+    uint32_t       caps[4];
+    uint32_t       reserved2;
+};
+
+static_assert(sizeof(DdsHeader) == 124, "DDS header must be 124 bytes");
+
+static const uint32_t dds_magic = 0x20534444;               // "DDS "
+static const uint32_t dds_flags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000;    // Caps, height, width, pixel format, mip count, linear size
+static const uint32_t dds_pixel_format_four_cc = 0x4;
+static const uint32_t dds_caps_texture = 0x1000, dds_caps_mipmap = 0x400000, dds_caps_complex = 0x8;
+static const uint32_t dds_mip_map_count_flag = 0x20000;
+
+// Files are read on worker threads and by cooker, which have no GL context to
+// ask for GL_MAX_TEXTURE_SIZE, so the limit guaranteed by GL 4.x is used
+static const uint32_t dds_max_size = 16384;
+
+static uint32_t four_cc(const char* code) {
+    return code[0] | code[1] << 8 | code[2] << 16 | (uint32_t)code[3] << 24;
+}
+
+GLenum block_gl_format(BlockFormat format) {
+    return format == BLOCK_BC1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+}
+
+bool read_dds(const char* path, CompressedImage& image) {
+    FILE* file = fopen(path, "rb");
+    if(!file) {
+        std::cerr << "Error : unable to open file " << path << std::endl;
+        return false;
+    }
+    std::vector<unsigned char> bytes;
+    unsigned char buffer[65536];
+    for(size_t count; (count = fread(buffer, 1, sizeof(buffer), file)) > 0;)
+        bytes.insert(bytes.end(), buffer, buffer + count);
+    fclose(file);
+
+    uint32_t magic = 0;
+    DdsHeader header;
+    if(bytes.size() < sizeof(magic) + sizeof(header)) {
+        std::cerr << "Error : not a DDS file " << path << std::endl;
+        return false;
+    }
+    memcpy(&magic, bytes.data(), sizeof(magic));
+    memcpy(&header, bytes.data() + sizeof(magic), sizeof(header));
+    if(magic != dds_magic || header.size != sizeof(header)) {
+        std::cerr << "Error : not a DDS file " << path << std::endl;
+        return false;
+    }
+
+    size_t block_bytes = 16;
+    if(!(header.pixel_format.flags & dds_pixel_format_four_cc)) {
+        std::cerr << "Error : DDS file is not block compressed " << path << std::endl;
+        return false;
+    } else if(header.pixel_format.four_cc == four_cc("DXT1")) {
+        image.format = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        block_bytes = 8;
+    } else if(header.pixel_format.four_cc == four_cc("DXT3")) {
+        image.format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+    } else if(header.pixel_format.four_cc == four_cc("DXT5")) {
+        image.format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    } else {
+        std::cerr << "Error : unsupported DDS format in " << path << std::endl;
+        return false;
+    }
+
+    if(header.width == 0 || header.height == 0 || header.width > dds_max_size || header.height > dds_max_size) {
+        std::cerr << "Error : unsupported DDS size " << header.width << "x" << header.height << " in " << path << std::endl;
+        return false;
+    }
+
+    // Levels past 1x1 are ignored
+    uint32_t full_chain = 1;
+    for(uint32_t size = std::max(header.width, header.height); size > 1; size >>= 1)
+        ++full_chain;
+    uint32_t levels = (header.flags & dds_mip_map_count_flag) && header.mip_map_count > 0 ? header.mip_map_count : 1;
+    levels = std::min(levels, full_chain);
+
+    const size_t data_offset = sizeof(magic) + sizeof(header);
+    const size_t data_size = bytes.size() - data_offset;
+    size_t offset = 0;
+    image.levels.clear();
+    for(uint32_t level = 0; level < levels; ++level) {
+        CompressedLevel info;
+        info.width = (int)std::max(1u, header.width >> level);
+        info.height = (int)std::max(1u, header.height >> level);
+        info.offset = offset;
+        info.size = (size_t)std::max(1, (info.width + 3) / 4) * std::max(1, (info.height + 3) / 4) * block_bytes;
+        if(info.size > data_size - offset) {
+            std::cerr << "Error : truncated DDS file " << path << std::endl;
+            image.levels.clear();
+            return false;
+        }
+        image.levels.push_back(info);
+        offset += info.size;
+    }
+    image.data.assign(bytes.begin() + data_offset, bytes.begin() + data_offset + offset);
+    return true;
+}
+
+bool write_dds(const char* path, const CompressedImage& image) {
+    if(image.levels.empty())
+        return false;
+
+    DdsHeader header;
+    memset(&header, 0, sizeof(header));
+    header.size = sizeof(header);
+    header.flags = dds_flags;
+    header.width = image.levels[0].width;
+    header.height = image.levels[0].height;
+    header.pitch_or_linear_size = (uint32_t)image.levels[0].size;
+    header.mip_map_count = (uint32_t)image.levels.size();
+    header.pixel_format.size = sizeof(DdsPixelFormat);
+    header.pixel_format.flags = dds_pixel_format_four_cc;
+    header.pixel_format.four_cc = four_cc(image.format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ? "DXT1" :
+                                          image.format == GL_COMPRESSED_RGBA_S3TC_DXT3_EXT ? "DXT3" : "DXT5");
+    header.caps[0] = dds_caps_texture | (image.levels.size() > 1 ? dds_caps_mipmap | dds_caps_complex : 0);
+
+    FILE* file = fopen(path, "wb");
+    if(!file) {
+        std::cerr << "Error : unable to create file " << path << std::endl;
+        return false;
+    }
+    bool result = fwrite(&dds_magic, sizeof(dds_magic), 1, file) == 1 &&
+                  fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  fwrite(image.data.data(), 1, image.data.size(), file) == image.data.size();
+    if(fclose(file) != 0 || !result) {
+        std::cerr << "Error : unable to write file " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool is_dds_path(const std::string& path) {
+    return path.size() > 4 && (path.compare(path.size() - 4, 4, ".dds") == 0 || path.compare(path.size() - 4, 4, ".DDS") == 0);
+}
@@ -0,0 +1,33 @@
+#include <gl_extensions.h>
+#include <cstring>    // strcmp
+
+GLExtensions gl_extensions = {};
+
+static bool is_version_at_least(GLint major, GLint minor) {
+    return gl_extensions.major_version > major ||
+          (gl_extensions.major_version == major && gl_extensions.minor_version >= minor);
+}
+
+bool has_gl_extension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for(GLint i = 0; i < count; ++i) {
+        const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        if(extension && strcmp(extension, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+void load_gl_extensions() {
+    glGetIntegerv(GL_MAJOR_VERSION, &gl_extensions.major_version);
+    glGetIntegerv(GL_MINOR_VERSION, &gl_extensions.minor_version);
+
+    gl_extensions.texture_filter_anisotropic = is_version_at_least(4, 6) ||
+                                               has_gl_extension("GL_ARB_texture_filter_anisotropic") ||
+                                               has_gl_extension("GL_EXT_texture_filter_anisotropic");
+    gl_extensions.snorm_gl42 = is_version_at_least(4, 2);
+    gl_extensions.max_anisotropy = 1.0f;
+    if(gl_extensions.texture_filter_anisotropic)
+        glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &gl_extensions.max_anisotropy);
+}
@@ -0,0 +1,132 @@
+#include <gpu_profiler.h>
+#include <iomanip>
+
+// Weight of newest frame in moving average
+static const double average_weight = 0.05;
+
+GpuProfiler::GpuProfiler(bool enable) : enabled(enable), frames(), frame_index(0), depth(0), dropped(0) {
+    if(!enabled)
+        return;
+    for(Frame& frame : frames) {
+        glGenQueries(max_scopes * 2, frame.queries);
+        frame.scopes.reserve(max_scopes);
+    }
+}
+
+GpuProfiler::~GpuProfiler() {
+    if(!enabled)
+        return;
+    for(Frame& frame : frames)
+        glDeleteQueries(max_scopes * 2, frame.queries);
+}
+
+bool GpuProfiler::begin_frame() {
+    if(!enabled)
+        return false;
+
+    frame_index = (frame_index + 1) % latency;
+    depth = 0;
+    Frame& frame = frames[frame_index];
+    if(frame.scopes.empty())
+        return false;
+
+    // Timestamps complete in order, last one available means all are
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(frame.last_query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if(available)
+        collect(frame);
+    else
+        ++dropped;
+    frame.scopes.clear();
+    return available != GL_FALSE;
+}
+
+void GpuProfiler::end_frame() {
+    // Scopes left open are not recorded
+    depth = 0;
+}
+
+int GpuProfiler::begin_scope(const char* name) {
+    if(!enabled)
+        return -1;
+
+    Frame& frame = frames[frame_index];
+    if(frame.scopes.size() >= max_scopes)
+        return -1;
+
+    int scope = (int)frame.scopes.size();
+    frame.scopes.push_back({ name, depth++ });
+    glQueryCounter(frame.queries[scope * 2], GL_TIMESTAMP);
+    return scope;
+}
+
+void GpuProfiler::end_scope(int scope) {
+    if(scope < 0)
+        return;
+
+    Frame& frame = frames[frame_index];
+    --depth;
+    frame.last_query = frame.queries[scope * 2 + 1];
+    glQueryCounter(frame.last_query, GL_TIMESTAMP);
+}
+
+void GpuProfiler::collect(Frame& frame) {
+    results.clear();
+    spans.clear();
+
+    for(unsigned int i = 0; i < frame.scopes.size(); ++i) {
+        const Scope& scope = frame.scopes[i];
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(frame.queries[i * 2], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(frame.queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+        const double time = end > begin ? (end - begin) * 1e-6 : 0.0;
+        spans.push_back({ scope.name, scope.depth, begin, end });
+
+        if(paths.size() <= scope.depth)
+            paths.resize(scope.depth + 1);
+        std::string& path = paths[scope.depth];
+        path.clear();
+        if(scope.depth)
+            path.append(paths[scope.depth - 1]).append("/");
+        path.append(scope.name);
+
+        // Repeated scope (loop body) adds to existing node
+        bool merged = false;
+        for(unsigned int j = 0; j < results.size() && !merged; ++j) {
+            if(result_paths[j] == path) {
+                results[j].time += time;
+                merged = true;
+            }
+        }
+        if(!merged) {
+            results.push_back({ scope.name, scope.depth, time, 0.0 });
+            if(result_paths.size() < results.size())
+                result_paths.resize(results.size());
+            result_paths[results.size() - 1] = path;
+        }
+    }
+
+    for(unsigned int i = 0; i < results.size(); ++i) {
+        auto found = averages.find(result_paths[i]);
+        if(found == averages.end())
+            found = averages.emplace(result_paths[i], results[i].time).first;
+        else
+            found->second += (results[i].time - found->second) * average_weight;
+        results[i].average = found->second;
+    }
+}
+
+void GpuProfiler::print(std::ostream& out) const {
+    const std::ios::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    out << "GPU time, ms (average) :" << std::endl;
+    for(const Result& result : results) {
+        out << std::string(2 + result.depth * 2, ' ') << std::left << std::setw(24 - result.depth * 2) << result.name
+            << std::right << std::fixed << std::setprecision(3) << std::setw(8) << result.time
+            << " (" << result.average << ")" << std::endl;
+    }
+    out.flags(flags);
+    out.precision(precision);
+    if(dropped)
+        out << "  frames dropped : " << dropped << std::endl;
+}
@@ -0,0 +1,276 @@
+#include <mip_generator.h>
+#include <algorithm>  // min, max
+#include <cmath>      // pow, sin, sqrt
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <immintrin.h>
+#define MIP_GENERATOR_SSE2
+#if defined(__GNUC__) || defined(__clang__)
+#define MIP_GENERATOR_AVX
+#endif
+#endif
+
+// Linear values are encoded back through table of 2^14 entries, error stays
+// below half of 8 bit step for whole range
+static const int encode_table_size = 1 << 14;
+
+struct ConversionTables {
+    float   srgb_to_linear[256];
+    float   unorm_to_float[256];
+    uint8_t linear_to_srgb[encode_table_size];
+
+    ConversionTables() {
+        for(int i = 0; i < 256; ++i) {
+            const float value = i / 255.0f;
+            srgb_to_linear[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+            unorm_to_float[i] = value;
+        }
+        for(int i = 0; i < encode_table_size; ++i) {
+            const float value = (float)i / (encode_table_size - 1);
+            const float srgb = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+            linear_to_srgb[i] = (uint8_t)(srgb * 255.0f + 0.5f);
+        }
+    }
+};
+
+static const ConversionTables& tables() {
+    static const ConversionTables instance;
+    return instance;
+}
+
+static void decode_row(const uint8_t* source, size_t pixels, int channels, bool srgb, float* destination) {
+    const ConversionTables& t = tables();
+    const float* color = srgb ? t.srgb_to_linear : t.unorm_to_float;
+    for(size_t p = 0; p < pixels; ++p) {
+        for(int c = 0; c < 3; ++c)
+            destination[c] = color[source[c]];
+        if(channels == 4)
+            destination[3] = t.unorm_to_float[source[3]];
+        source += channels;
+        destination += channels;
+    }
+}
+
+static void encode_row(const float* source, size_t pixels, int channels, bool srgb, uint8_t* destination) {
+    const ConversionTables& t = tables();
+    for(size_t p = 0; p < pixels; ++p) {
+        for(int c = 0; c < channels; ++c) {
+            const float value = std::min(1.0f, std::max(0.0f, source[c]));
+            destination[c] = srgb && c < 3 ?
+                t.linear_to_srgb[(int)(value * (encode_table_size - 1) + 0.5f)] :
+                (uint8_t)(value * 255.0f + 0.5f);
+        }
+        source += channels;
+        destination += channels;
+    }
+}
+
+// destination += source * weight, rows are channel agnostic float arrays
+static void accumulate_row_scalar(float* destination, const float* source, float weight, size_t count) {
+    for(size_t i = 0; i < count; ++i)
+        destination[i] += source[i] * weight;
+}
+
+#ifdef MIP_GENERATOR_SSE2
+static void accumulate_row_sse2(float* destination, const float* source, float weight, size_t count) {
+    const __m128 w = _mm_set1_ps(weight);
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4)
+        _mm_storeu_ps(destination + i, _mm_add_ps(_mm_loadu_ps(destination + i), _mm_mul_ps(_mm_loadu_ps(source + i), w)));
+    accumulate_row_scalar(destination + i, source + i, weight, count - i);
+}
+#endif
+
+#ifdef MIP_GENERATOR_AVX
+__attribute__((target("avx")))
+static void accumulate_row_avx(float* destination, const float* source, float weight, size_t count) {
+    const __m256 w = _mm256_set1_ps(weight);
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(destination + i, _mm256_add_ps(_mm256_loadu_ps(destination + i), _mm256_mul_ps(_mm256_loadu_ps(source + i), w)));
+    accumulate_row_scalar(destination + i, source + i, weight, count - i);
+}
+#endif
+
+static void accumulate_row(float* destination, const float* source, float weight, size_t count) {
+#if defined(MIP_GENERATOR_AVX)
+    static const bool has_avx = __builtin_cpu_supports("avx");
+    if(has_avx)
+        return accumulate_row_avx(destination, source, weight, count);
+#endif
+#if defined(MIP_GENERATOR_SSE2)
+    accumulate_row_sse2(destination, source, weight, count);
+#else
+    accumulate_row_scalar(destination, source, weight, count);
+#endif
+}
+
+// Sums pixel pairs of row : destination pixel x = source pixels 2x and 2x + 1
+static void pair_row(const float* source, int width, int next_width, int channels, float* destination) {
+#ifdef MIP_GENERATOR_SSE2
+    if(channels == 4) {
+        for(int x = 0; x < next_width; ++x) {
+            const int x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+            _mm_storeu_ps(destination + x * 4, _mm_add_ps(_mm_loadu_ps(source + x0 * 4), _mm_loadu_ps(source + x1 * 4)));
+        }
+        return;
+    }
+#endif
+    for(int x = 0; x < next_width; ++x) {
+        const int x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+        for(int c = 0; c < channels; ++c)
+            destination[x * channels + c] = source[x0 * channels + c] + source[x1 * channels + c];
+    }
+}
+
+static const int kaiser_taps = 8;
+
+// Kaiser windowed sinc for 2x reduction, taps cover source pixels
+// 2x - 3 .. 2x + 4 around destination pixel center 2x + 1
+struct KaiserKernel {
+    float weights[kaiser_taps];
+
+    KaiserKernel() {
+        const double alpha = 4.0, radius = kaiser_taps / 2, pi = 3.14159265358979323846;
+        auto bessel_i0 = [](double x) {
+            double sum = 1.0, term = 1.0;
+            for(int k = 1; k < 20; ++k) {
+                term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                sum += term;
+            }
+            return sum;
+        };
+
+        double total = 0.0;
+        for(int i = 0; i < kaiser_taps; ++i) {
+            const double distance = i - (kaiser_taps / 2 - 1) - 0.5;    // -3.5 .. 3.5
+            const double x = distance / 2.0;                            // In destination pixels
+            const double sinc = x == 0.0 ? 1.0 : std::sin(pi * x) / (pi * x);
+            const double ratio = distance / radius;
+            const double window = bessel_i0(alpha * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) / bessel_i0(alpha);
+            weights[i] = (float)(sinc * window);
+            total += weights[i];
+        }
+        for(int i = 0; i < kaiser_taps; ++i)
+            weights[i] = (float)(weights[i] / total);
+    }
+};
+
+static const KaiserKernel& kaiser() {
+    static const KaiserKernel instance;
+    return instance;
+}
+
+static void box_rows(const uint8_t* source, int width, int height, int channels, bool srgb,
+                     MipLevel& destination, int first_row, int last_row) {
+    const int next_width = destination.width;
+    std::vector<float> row0((size_t)width * channels), row1((size_t)width * channels);
+    std::vector<float> paired((size_t)next_width * channels);
+    const size_t row_bytes = (size_t)width * channels;
+
+    for(int y = first_row; y < last_row; ++y) {
+        const int y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+        decode_row(source + y0 * row_bytes, width, channels, srgb, row0.data());
+        decode_row(source + y1 * row_bytes, width, channels, srgb, row1.data());
+        accumulate_row(row0.data(), row1.data(), 1.0f, row0.size());
+        pair_row(row0.data(), width, next_width, channels, paired.data());
+        for(float& value : paired)
+            value *= 0.25f;
+        encode_row(paired.data(), next_width, channels, srgb,
+                   destination.pixels.data() + (size_t)y * next_width * channels);
+    }
+}
+
+static void kaiser_rows(const uint8_t* source, int width, int height, int channels, bool srgb,
+                        MipLevel& destination, int first_row, int last_row) {
+    const KaiserKernel& kernel = kaiser();
+    const int next_width = destination.width;
+    const size_t row_floats = (size_t)width * channels;
+    std::vector<float> column(row_floats), filtered((size_t)next_width * channels);
+
+    // Decoded source rows, consecutive destination rows share 6 of 8 rows
+    std::vector<float> ring(kaiser_taps * row_floats);
+    int ring_rows[kaiser_taps];
+    std::fill(ring_rows, ring_rows + kaiser_taps, -1);
+
+    for(int y = first_row; y < last_row; ++y) {
+        // Vertical pass : weighted sum of source rows, whole rows at once
+        std::fill(column.begin(), column.end(), 0.0f);
+        for(int tap = 0; tap < kaiser_taps; ++tap) {
+            const int unclamped_y = y * 2 - (kaiser_taps / 2 - 1) + tap;
+            const int source_y = std::min(height - 1, std::max(0, unclamped_y));
+            const int slot = (unclamped_y + kaiser_taps) % kaiser_taps;
+            float* row = &ring[slot * row_floats];
+            if(ring_rows[slot] != source_y) {
+                decode_row(source + source_y * row_floats, width, channels, srgb, row);
+                ring_rows[slot] = source_y;
+            }
+            accumulate_row(column.data(), row, kernel.weights[tap], row_floats);
+        }
+
+        // Horizontal pass
+        for(int x = 0; x < next_width; ++x) {
+            float* pixel = &filtered[(size_t)x * channels];
+            for(int c = 0; c < channels; ++c)
+                pixel[c] = 0.0f;
+            for(int tap = 0; tap < kaiser_taps; ++tap) {
+                const int source_x = std::min(width - 1, std::max(0, x * 2 - (kaiser_taps / 2 - 1) + tap));
+                for(int c = 0; c < channels; ++c)
+                    pixel[c] += column[(size_t)source_x * channels + c] * kernel.weights[tap];
+            }
+        }
+        encode_row(filtered.data(), next_width, channels, srgb,
+                   destination.pixels.data() + (size_t)y * next_width * channels);
+    }
+}
+
+void generate_mip(const uint8_t* source, int width, int height, int channels, bool srgb,
+                  MipFilter filter, MipLevel& destination, unsigned int threads) {
+    destination.width = std::max(1, width / 2);
+    destination.height = std::max(1, height / 2);
+    destination.pixels.resize((size_t)destination.width * destination.height * channels);
+
+    auto rows = [&](int first_row, int last_row) {
+        if(filter == MIP_FILTER_KAISER)
+            kaiser_rows(source, width, height, channels, srgb, destination, first_row, last_row);
+        else
+            box_rows(source, width, height, channels, srgb, destination, first_row, last_row);
+    };
+
+    if(threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    // Thread start is not worth it for small levels
+    const size_t min_pixels_per_thread = 64 * 1024;
+    const size_t pixels = (size_t)destination.width * destination.height;
+    threads = (unsigned int)std::min<size_t>(threads, std::max<size_t>(1, pixels / min_pixels_per_thread));
+    threads = std::min(threads, (unsigned int)destination.height);
+
+    if(threads <= 1) {
+        rows(0, destination.height);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    for(unsigned int t = 0; t < threads; ++t)
+        workers.emplace_back(rows, destination.height * t / threads, destination.height * (t + 1) / threads);
+    for(std::thread& worker : workers)
+        worker.join();
+}
+
+void generate_mip_chain(const uint8_t* pixels, int width, int height, int channels, bool srgb,
+                        MipFilter filter, std::vector<MipLevel>& levels, unsigned int threads) {
+    // Levels keep their place, next level reads previous one
+    int count = 0;
+    for(int size = std::max(width, height); size > 1; size /= 2)
+        ++count;
+    levels.clear();
+    levels.reserve(count);
+    while(width > 1 || height > 1) {
+        levels.emplace_back();
+        generate_mip(pixels, width, height, channels, srgb, filter, levels.back(), threads);
+        pixels = levels.back().pixels.data();
+        width = levels.back().width;
+        height = levels.back().height;
+    }
+}
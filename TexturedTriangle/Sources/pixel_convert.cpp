@@ -0,0 +1,211 @@
+#include <pixel_convert.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <immintrin.h>
+#define PIXEL_CONVERT_SSE2
+#if defined(__GNUC__) || defined(__clang__)
+#define PIXEL_CONVERT_SSSE3
+#define PIXEL_CONVERT_AVX2
+#endif
+#endif
+
+// Byte shuffles of 4 pixels, -1 is zero byte (alpha is or-ed in later)
+static const int8_t rgb_to_rgba_mask[16] = { 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1 };
+static const int8_t bgr_to_rgba_mask[16] = { 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1 };
+static const int8_t bgra_to_rgba_mask[16] = { 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15 };
+
+static void convert_3_to_4_scalar(const uint8_t* source, uint8_t* destination, size_t pixels, bool swap) {
+    const int r = swap ? 2 : 0, b = swap ? 0 : 2;
+    for(size_t i = 0; i < pixels; ++i) {
+        destination[0] = source[r];
+        destination[1] = source[1];
+        destination[2] = source[b];
+        destination[3] = 255;
+        source += 3;
+        destination += 4;
+    }
+}
+
+#ifdef PIXEL_CONVERT_SSSE3
+// 16 pixels per iteration : 48 bytes are shuffled into 4 registers
+__attribute__((target("ssse3")))
+static size_t convert_3_to_4_ssse3(const uint8_t* source, uint8_t* destination, size_t pixels, const int8_t* shuffle) {
+    const __m128i mask = _mm_loadu_si128((const __m128i*)shuffle);
+    const __m128i alpha = _mm_set1_epi32((int)0xff000000);
+    size_t i = 0;
+    for(; i + 16 <= pixels; i += 16) {
+        const __m128i a = _mm_loadu_si128((const __m128i*)(source + i * 3));
+        const __m128i b = _mm_loadu_si128((const __m128i*)(source + i * 3 + 16));
+        const __m128i c = _mm_loadu_si128((const __m128i*)(source + i * 3 + 32));
+        __m128i* output = (__m128i*)(destination + i * 4);
+        _mm_storeu_si128(output + 0, _mm_or_si128(_mm_shuffle_epi8(a, mask), alpha));
+        _mm_storeu_si128(output + 1, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(b, a, 12), mask), alpha));
+        _mm_storeu_si128(output + 2, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(c, b, 8), mask), alpha));
+        _mm_storeu_si128(output + 3, _mm_or_si128(_mm_shuffle_epi8(_mm_srli_si128(c, 4), mask), alpha));
+    }
+    return i;
+}
+
+__attribute__((target("ssse3")))
+static size_t swizzle_4_ssse3(const uint8_t* source, uint8_t* destination, size_t pixels) {
+    const __m128i mask = _mm_loadu_si128((const __m128i*)bgra_to_rgba_mask);
+    size_t i = 0;
+    for(; i + 4 <= pixels; i += 4)
+        _mm_storeu_si128((__m128i*)(destination + i * 4),
+                         _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(source + i * 4)), mask));
+    return i;
+}
+#endif
+
+#ifdef PIXEL_CONVERT_AVX2
+// 8 pixels per iteration : lanes get pixels 0-3 and 4-7, shuffle works per lane.
+// Second load reads 4 bytes past 8 pixels, so loop stops 2 pixels earlier.
+__attribute__((target("avx2")))
+static size_t convert_3_to_4_avx2(const uint8_t* source, uint8_t* destination, size_t pixels, const int8_t* shuffle) {
+    const __m256i mask = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)shuffle));
+    const __m256i alpha = _mm256_set1_epi32((int)0xff000000);
+    size_t i = 0;
+    for(; i + 10 <= pixels; i += 8) {
+        const __m128i low = _mm_loadu_si128((const __m128i*)(source + i * 3));
+        const __m128i high = _mm_loadu_si128((const __m128i*)(source + i * 3 + 12));
+        const __m256i both = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+        _mm256_storeu_si256((__m256i*)(destination + i * 4), _mm256_or_si256(_mm256_shuffle_epi8(both, mask), alpha));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t swizzle_4_avx2(const uint8_t* source, uint8_t* destination, size_t pixels) {
+    const __m256i mask = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)bgra_to_rgba_mask));
+    size_t i = 0;
+    for(; i + 8 <= pixels; i += 8)
+        _mm256_storeu_si256((__m256i*)(destination + i * 4),
+                            _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(source + i * 4)), mask));
+    return i;
+}
+#endif
+
+static void convert_3_to_4(const uint8_t* source, uint8_t* destination, size_t pixels, bool swap) {
+    size_t i = 0;
+    const int8_t* mask = swap ? bgr_to_rgba_mask : rgb_to_rgba_mask;
+#ifdef PIXEL_CONVERT_AVX2
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    if(has_avx2)
+        i = convert_3_to_4_avx2(source, destination, pixels, mask);
+#endif
+#ifdef PIXEL_CONVERT_SSSE3
+    static const bool has_ssse3 = __builtin_cpu_supports("ssse3");
+    if(has_ssse3)
+        i += convert_3_to_4_ssse3(source + i * 3, destination + i * 4, pixels - i, mask);
+#endif
+    (void)mask;
+    convert_3_to_4_scalar(source + i * 3, destination + i * 4, pixels - i, swap);
+}
+
+void convert_rgb_to_rgba(const uint8_t* source, uint8_t* destination, size_t pixels) {
+    convert_3_to_4(source, destination, pixels, false);
+}
+
+void convert_bgr_to_rgba(const uint8_t* source, uint8_t* destination, size_t pixels) {
+    convert_3_to_4(source, destination, pixels, true);
+}
+
+void swizzle_bgra_to_rgba(const uint8_t* source, uint8_t* destination, size_t pixels) {
+    size_t i = 0;
+#ifdef PIXEL_CONVERT_AVX2
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    if(has_avx2)
+        i = swizzle_4_avx2(source, destination, pixels);
+#endif
+#ifdef PIXEL_CONVERT_SSSE3
+    static const bool has_ssse3 = __builtin_cpu_supports("ssse3");
+    if(has_ssse3)
+        i += swizzle_4_ssse3(source + i * 4, destination + i * 4, pixels - i);
+#endif
+    for(; i < pixels; ++i) {
+        const uint8_t b = source[i * 4], g = source[i * 4 + 1], r = source[i * 4 + 2], a = source[i * 4 + 3];
+        destination[i * 4] = r;
+        destination[i * 4 + 1] = g;
+        destination[i * 4 + 2] = b;
+        destination[i * 4 + 3] = a;
+    }
+}
+
+// Exact x * a / 255 with rounding
+static inline uint8_t multiply_unorm8(unsigned int x, unsigned int a) {
+    const unsigned int t = x * a + 128;
+    return (uint8_t)((t + (t >> 8)) >> 8);
+}
+
+void premultiply_alpha(uint8_t* rgba, size_t pixels) {
+    size_t i = 0;
+#ifdef PIXEL_CONVERT_SSE2
+    // 4 pixels per iteration in 16 bit lanes, alpha is broadcast with word shuffles
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi16(128);
+    const __m128i alpha_mask = _mm_set1_epi32((int)0xff000000);
+    for(; i + 4 <= pixels; i += 4) {
+        const __m128i source = _mm_loadu_si128((const __m128i*)(rgba + i * 4));
+        __m128i low = _mm_unpacklo_epi8(source, zero);
+        __m128i high = _mm_unpackhi_epi8(source, zero);
+        const __m128i low_alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(low, 0xff), 0xff);
+        const __m128i high_alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(high, 0xff), 0xff);
+        low = _mm_add_epi16(_mm_mullo_epi16(low, low_alpha), round);
+        high = _mm_add_epi16(_mm_mullo_epi16(high, high_alpha), round);
+        low = _mm_srli_epi16(_mm_add_epi16(low, _mm_srli_epi16(low, 8)), 8);
+        high = _mm_srli_epi16(_mm_add_epi16(high, _mm_srli_epi16(high, 8)), 8);
+        const __m128i result = _mm_packus_epi16(low, high);
+        // Alpha itself is kept
+        _mm_storeu_si128((__m128i*)(rgba + i * 4),
+                         _mm_or_si128(_mm_andnot_si128(alpha_mask, result), _mm_and_si128(alpha_mask, source)));
+    }
+#endif
+    for(; i < pixels; ++i) {
+        uint8_t* pixel = rgba + i * 4;
+        for(int c = 0; c < 3; ++c)
+            pixel[c] = multiply_unorm8(pixel[c], pixel[3]);
+    }
+}
+
+void convert_to_rgba(const uint8_t* source, int channels, uint8_t* destination, size_t pixels) {
+    switch(channels) {
+    case 3:
+        convert_rgb_to_rgba(source, destination, pixels);
+        return;
+    case 4:
+        if(source != destination)
+            for(size_t i = 0; i < pixels * 4; ++i)
+                destination[i] = source[i];
+        return;
+    }
+
+    for(size_t i = 0; i < pixels; ++i) {
+        const uint8_t gray = source[i * channels];
+        destination[i * 4] = destination[i * 4 + 1] = destination[i * 4 + 2] = gray;
+        destination[i * 4 + 3] = channels == 2 ? source[i * 2 + 1] : 255;
+    }
+}
+
+GLint unpack_alignment(size_t row_bytes) {
+    if(row_bytes % 8 == 0)
+        return 8;
+    if(row_bytes % 4 == 0)
+        return 4;
+    return row_bytes % 2 == 0 ? 2 : 1;
+}
+
+static bool srgb_color = true;
+
+void set_srgb_color_textures(bool enable) {
+    srgb_color = enable;
+}
+
+bool srgb_color_textures() {
+    return srgb_color;
+}
+
+GLint color_internal_format(int channels, bool srgb) {
+    if(channels == 3)
+        return srgb ? GL_SRGB8 : GL_RGB8;
+    return srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+}
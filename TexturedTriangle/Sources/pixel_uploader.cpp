@@ -0,0 +1,104 @@
+#include <pixel_uploader.h>
+#include <cstdint>    // uintptr_t
+#include <cstring>    // memcpy
+
+PixelUploader::PixelUploader(unsigned int buffers) : pool(buffers) {
+    for(Staging& staging : pool) {
+        glGenBuffers(1, &staging.pbo_id);
+        staging.capacity = 0;
+        staging.fence = 0;
+    }
+}
+
+PixelUploader::~PixelUploader() {
+    for(Staging& staging : pool) {
+        if(staging.fence)
+            glDeleteSync(staging.fence);
+        glDeleteBuffers(1, &staging.pbo_id);
+    }
+}
+
+// Staging buffer whose previous upload is complete, fences are polled without waiting
+PixelUploader::Staging* PixelUploader::acquire(GLsizeiptr size) {
+    Staging* result = NULL;
+    for(Staging& staging : pool) {
+        if(staging.fence) {
+            GLenum status = glClientWaitSync(staging.fence, 0, 0);
+            if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+                continue;
+            glDeleteSync(staging.fence);
+            staging.fence = 0;
+        }
+        // Prefer buffer which needs no reallocation
+        if(!result || (result->capacity < size && staging.capacity >= size))
+            result = &staging;
+    }
+    return result;
+}
+
+bool PixelUploader::upload(GLint level, GLint internal_format, GLsizei width, GLsizei height, GLenum format, GLenum type,
+                           const void* pixels, GLsizeiptr size) {
+    const PixelLevel single = { width, height, pixels, size };
+    return upload(internal_format, format, type, &single, 1, level);
+}
+
+bool PixelUploader::upload(GLint internal_format, GLenum format, GLenum type,
+                           const PixelLevel* levels, unsigned int count, GLint first_level) {
+    // Levels are placed one after another, offsets keep 4 byte alignment
+    std::vector<GLsizeiptr> offsets(count);
+    GLsizeiptr size = 0;
+    for(unsigned int i = 0; i < count; ++i) {
+        offsets[i] = size;
+        size += (levels[i].size + 3) & ~(GLsizeiptr)3;
+    }
+
+    Staging* staging = acquire(size);
+    if(!staging)
+        return false;
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging->pbo_id);
+    if(staging->capacity < size) {
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+        staging->capacity = size;
+    }
+
+    // GPU is done with buffer (fence passed), so no synchronization is needed
+    unsigned char* memory = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if(!memory) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+    for(unsigned int i = 0; i < count; ++i)
+        memcpy(memory + offsets[i], levels[i].pixels, levels[i].size);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    // Last parameter is offset in bound unpack buffer
+    for(unsigned int i = 0; i < count; ++i) {
+        const PixelLevel& level = levels[i];
+        const void* offset = (const void*)(uintptr_t)offsets[i];
+        if(internal_format != 0)
+            glTexImage2D(GL_TEXTURE_2D, first_level + i, internal_format, level.width, level.height, 0, format, type, offset);
+        else
+            glTexSubImage2D(GL_TEXTURE_2D, first_level + i, 0, 0, level.width, level.height, format, type, offset);
+    }
+    staging->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return true;
+}
+
+unsigned int PixelUploader::busy() {
+    unsigned int count = 0;
+    for(Staging& staging : pool) {
+        if(!staging.fence)
+            continue;
+        GLenum status = glClientWaitSync(staging.fence, 0, 0);
+        if(status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+            glDeleteSync(staging.fence);
+            staging.fence = 0;
+        } else {
+            ++count;
+        }
+    }
+    return count;
+}
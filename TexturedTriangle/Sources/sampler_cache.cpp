@@ -0,0 +1,48 @@
+#include <sampler_cache.h>
+#include <gl_extensions.h>
+#include <algorithm>
+#include <functional>
+
+SamplerDesc trilinear_sampler(GLint wrap) {
+    return { GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, wrap, wrap, 1.0f, 0.0f };
+}
+
+SamplerDesc anisotropic_sampler(GLfloat anisotropy, GLint wrap) {
+    return { GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, wrap, wrap, anisotropy, 0.0f };
+}
+
+size_t SamplerCache::Hash::operator() (const SamplerDesc& desc) const {
+    size_t hash = std::hash<GLint>()(desc.min_filter);
+    for(size_t value : { std::hash<GLint>()(desc.mag_filter), std::hash<GLint>()(desc.wrap_s),
+                         std::hash<GLint>()(desc.wrap_t), std::hash<GLfloat>()(desc.anisotropy),
+                         std::hash<GLfloat>()(desc.lod_bias) })
+        hash = hash * 31 + value;
+    return hash;
+}
+
+SamplerCache::~SamplerCache() {
+    for(auto& sampler : samplers)
+        glDeleteSamplers(1, &sampler.second);
+}
+
+GLuint SamplerCache::get(const SamplerDesc& desc) {
+    // Anisotropy beyond hardware limit is the same sampler
+    SamplerDesc key = desc;
+    key.anisotropy = std::min(std::max(1.0f, key.anisotropy), gl_extensions.max_anisotropy);
+
+    auto found = samplers.find(key);
+    if(found != samplers.end())
+        return found->second;
+
+    GLuint sampler_id;
+    glGenSamplers(1, &sampler_id);
+    glSamplerParameteri(sampler_id, GL_TEXTURE_MIN_FILTER, key.min_filter);
+    glSamplerParameteri(sampler_id, GL_TEXTURE_MAG_FILTER, key.mag_filter);
+    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_S, key.wrap_s);
+    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_T, key.wrap_t);
+    glSamplerParameterf(sampler_id, GL_TEXTURE_LOD_BIAS, key.lod_bias);
+    if(gl_extensions.texture_filter_anisotropic)
+        glSamplerParameterf(sampler_id, GL_TEXTURE_MAX_ANISOTROPY, key.anisotropy);
+    samplers[key] = sampler_id;
+    return sampler_id;
+}
@@ -0,0 +1,136 @@
+#include <sprite_batch.h>
+#include <state_cache.h>
+#include <cstddef>    // offsetof
+#include <iostream>
+
+static const char* sprite_vertex_shader_text =
+"#version 330 core\n"
+"layout (location = 0) in vec4 rect;\n"
+"layout (location = 1) in vec4 uvRect;\n"
+"layout (location = 2) in float layer;\n"
+"layout (location = 3) in vec4 color;\n"
+"uniform vec2 viewport;\n"
+"out vec3 textureCoord;\n"
+"out vec4 spriteColor;\n"
+"void main()\n"
+"{\n"
+"    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);\n"
+"    gl_Position = vec4((rect.xy + corner * rect.zw) / viewport * 2.0 - 1.0, 0.0, 1.0);\n"
+"    textureCoord = vec3(mix(uvRect.xy, uvRect.zw, corner), layer);\n"
+"    spriteColor = color;\n"
+"}";
+
+static const char* sprite_fragment_shader_text =
+"#version 330 core\n"
+"in vec3 textureCoord;\n"
+"in vec4 spriteColor;\n"
+"out vec4 color;\n"
+"uniform sampler2DArray atlas;\n"
+"void main()\n"
+"{\n"
+"    color = texture(atlas, textureCoord) * spriteColor;\n"
+"}\n";
+
+static GLuint compile_shader(GLenum type, const char* text) {
+    GLuint shader_id = glCreateShader(type);
+    glShaderSource(shader_id, 1, &text, NULL);
+    glCompileShader(shader_id);
+    GLint status;
+    glGetShaderiv(shader_id, GL_COMPILE_STATUS, &status);
+    if(status != GL_TRUE) {
+        GLchar info_log[512];
+        glGetShaderInfoLog(shader_id, sizeof(info_log), NULL, info_log);
+        std::cerr << "Error  : failed to compile sprite shader" << std::endl;
+        std::cerr << "Info   : " << info_log << std::endl;
+        glDeleteShader(shader_id);
+        return 0;
+    }
+    return shader_id;
+}
+
+SpriteBatch::SpriteBatch(size_t capacity)
+    : capacity(capacity), program_id(0), vao_id(0), vbo_id(0), viewport_location(-1), texture_id(0), draw_calls_count(0) {
+    sprites.reserve(capacity);
+
+    GLuint vertex_shader_id = compile_shader(GL_VERTEX_SHADER, sprite_vertex_shader_text);
+    GLuint fragment_shader_id = compile_shader(GL_FRAGMENT_SHADER, sprite_fragment_shader_text);
+    if(vertex_shader_id && fragment_shader_id) {
+        program_id = glCreateProgram();
+        glAttachShader(program_id, vertex_shader_id);
+        glAttachShader(program_id, fragment_shader_id);
+        glLinkProgram(program_id);
+        GLint status;
+        glGetProgramiv(program_id, GL_LINK_STATUS, &status);
+        if(status != GL_TRUE) {
+            std::cerr << "Error : failed to create sprite shader program" << std::endl;
+            glDeleteProgram(program_id);
+            program_id = 0;
+        }
+    }
+    glDeleteShader(vertex_shader_id);
+    glDeleteShader(fragment_shader_id);
+    if(!program_id)
+        return;
+
+    viewport_location = glGetUniformLocation(program_id, "viewport");
+    glUseProgram(program_id);
+    glUniform1i(glGetUniformLocation(program_id, "atlas"), 0);
+
+    // One Sprite per instance
+    glGenVertexArrays(1, &vao_id);
+    glGenBuffers(1, &vbo_id);
+    glBindVertexArray(vao_id);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
+    glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(Sprite), NULL, GL_STREAM_DRAW);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Sprite), (const void*)offsetof(Sprite, x));
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Sprite), (const void*)offsetof(Sprite, u0));
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(Sprite), (const void*)offsetof(Sprite, layer));
+    glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Sprite), (const void*)offsetof(Sprite, color));
+    for(GLuint location = 0; location < 4; ++location) {
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+    glBindVertexArray(0);
+}
+
+SpriteBatch::~SpriteBatch() {
+    if(vbo_id)
+        glDeleteBuffers(1, &vbo_id);
+    if(vao_id)
+        glDeleteVertexArrays(1, &vao_id);
+    if(program_id)
+        glDeleteProgram(program_id);
+}
+
+void SpriteBatch::begin(int viewport_width, int viewport_height) {
+    sprites.clear();
+    texture_id = 0;
+    draw_calls_count = 0;
+    glUseProgram(program_id);
+    glUniform2f(viewport_location, (float)viewport_width, (float)viewport_height);
+    glBindVertexArray(vao_id);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
+}
+
+void SpriteBatch::draw(GLuint texture, const AtlasRegion& region, float x, float y, float width, float height,
+                       uint32_t color) {
+    if(texture != texture_id || sprites.size() == capacity) {
+        flush();
+        texture_id = texture;
+    }
+    sprites.push_back({ x, y, width, height, region.u0, region.v0, region.u1, region.v1, (float)region.layer, color });
+}
+
+void SpriteBatch::flush() {
+    if(sprites.empty() || !program_id)
+        return;
+
+    // Buffer is orphaned, so driver does not wait for previous draw reading it
+    glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(Sprite), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sprites.size() * sizeof(Sprite), sprites.data());
+    glActiveTexture(GL_TEXTURE0);
+    bind_texture_direct(GL_TEXTURE_2D_ARRAY, texture_id);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)sprites.size());
+    sprites.clear();
+    ++draw_calls_count;
+}
@@ -0,0 +1,86 @@
+#include <state_cache.h>
+
+// Object id no bind call can match
+static const GLuint unknown = 0xffffffff;
+
+// Counts binds done around caches, GL calls are made from one thread
+static unsigned int direct_binds = 0;
+
+void bind_texture_direct(GLenum target, GLuint id) {
+    glBindTexture(target, id);
+    ++direct_binds;
+}
+
+StateCache::StateCache() : calls_count(0), skipped_count(0) {
+    invalidate();
+}
+
+void StateCache::invalidate() {
+    program_id = unknown;
+    vertex_array_id = unknown;
+    for(unsigned int unit = 0; unit < max_units; ++unit)
+        samplers[unit] = unknown;
+    forget_textures();
+}
+
+// Direct binds may go to any unit, active unit is forgotten too
+void StateCache::forget_textures() {
+    active_unit = max_units;
+    for(unsigned int unit = 0; unit < max_units; ++unit) {
+        texture_targets[unit] = 0;
+        textures[unit] = unknown;
+    }
+    direct_binds_seen = direct_binds;
+}
+
+void StateCache::activate(unsigned int unit) {
+    if(active_unit == unit)
+        return;
+    glActiveTexture(GL_TEXTURE0 + unit);
+    active_unit = unit;
+}
+
+void StateCache::use_program(GLuint id) {
+    if(program_id == id) {
+        ++skipped_count;
+        return;
+    }
+    glUseProgram(id);
+    program_id = id;
+    ++calls_count;
+}
+
+void StateCache::bind_vertex_array(GLuint id) {
+    if(vertex_array_id == id) {
+        ++skipped_count;
+        return;
+    }
+    glBindVertexArray(id);
+    vertex_array_id = id;
+    ++calls_count;
+}
+
+// One target per unit is tracked, which is all one sampler uniform can read
+void StateCache::bind_texture(unsigned int unit, GLenum target, GLuint id) {
+    if(direct_binds_seen != direct_binds)
+        forget_textures();
+    if(textures[unit] == id && texture_targets[unit] == target) {
+        ++skipped_count;
+        return;
+    }
+    activate(unit);
+    glBindTexture(target, id);
+    texture_targets[unit] = target;
+    textures[unit] = id;
+    ++calls_count;
+}
+
+void StateCache::bind_sampler(unsigned int unit, GLuint id) {
+    if(samplers[unit] == id) {
+        ++skipped_count;
+        return;
+    }
+    glBindSampler(unit, id);
+    samplers[unit] = id;
+    ++calls_count;
+}
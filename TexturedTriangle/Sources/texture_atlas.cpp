@@ -0,0 +1,200 @@
+#include <texture_atlas.h>
+#include <texture_loader.h>
+#include <mip_generator.h>
+#include <pixel_convert.h>
+#include <state_cache.h>
+#include <algorithm>
+#include <climits>
+#include <iostream>
+#include <numeric>
+
+SkylinePacker::SkylinePacker(int width, int height) : width(width), height(height) {
+    skyline.push_back({ 0, 0, width });
+}
+
+int SkylinePacker::fit(size_t index, int rect_width, int rect_height) const {
+    if(skyline[index].x + rect_width > width)
+        return -1;
+    int top = 0;
+    for(int remaining = rect_width; remaining > 0; remaining -= skyline[index++].width) {
+        top = std::max(top, skyline[index].y);
+        if(top + rect_height > height)
+            return -1;
+    }
+    return top;
+}
+
+bool SkylinePacker::insert(int rect_width, int rect_height, int& x, int& y) {
+    // Lowest resulting top, narrowest segment on tie
+    int best_top = INT_MAX, best_width = INT_MAX;
+    size_t best = skyline.size();
+    for(size_t i = 0; i < skyline.size(); ++i) {
+        const int top = fit(i, rect_width, rect_height);
+        if(top < 0)
+            continue;
+        if(top + rect_height < best_top || (top + rect_height == best_top && skyline[i].width < best_width)) {
+            best_top = top + rect_height;
+            best_width = skyline[i].width;
+            best = i;
+            y = top;
+        }
+    }
+    if(best == skyline.size())
+        return false;
+
+    x = skyline[best].x;
+    skyline.insert(skyline.begin() + best, { x, best_top, rect_width });
+
+    // Segments under new one are cut
+    const int right = x + rect_width;
+    for(size_t i = best + 1; i < skyline.size() && skyline[i].x < right;) {
+        const int cut = std::min(right - skyline[i].x, skyline[i].width);
+        skyline[i].x += cut;
+        skyline[i].width -= cut;
+        if(skyline[i].width > 0)
+            break;
+        skyline.erase(skyline.begin() + i);
+    }
+
+    for(size_t i = 0; i + 1 < skyline.size();) {
+        if(skyline[i].y == skyline[i + 1].y) {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        } else {
+            ++i;
+        }
+    }
+    return true;
+}
+
+TextureAtlas::TextureAtlas(int page_size, int max_level)
+    : page_size(page_size), max_level(max_level), texture_id(0), layers_count(0) {
+    // Level max_level must still be at least one texel
+    while(this->max_level > 0 && (page_size >> this->max_level) == 0)
+        --this->max_level;
+}
+
+TextureAtlas::~TextureAtlas() {
+    if(texture_id)
+        glDeleteTextures(1, &texture_id);
+}
+
+int TextureAtlas::add(const uint8_t* rgba, int width, int height) {
+    // Border of 2^max_level pixels on each side, cell is multiple of it
+    const int alignment = 1 << max_level;
+    const int cell_width = (width + alignment - 1) / alignment * alignment + alignment * 2;
+    const int cell_height = (height + alignment - 1) / alignment * alignment + alignment * 2;
+    if(width <= 0 || height <= 0 || cell_width > page_size || cell_height > page_size) {
+        std::cerr << "Error : image " << width << "x" << height << " does not fit into atlas page" << std::endl;
+        return -1;
+    }
+
+    images.push_back({ width, height, std::vector<uint8_t>(rgba, rgba + (size_t)width * height * 4) });
+    regions.push_back({ -1, width, height, 0.0f, 0.0f, 0.0f, 0.0f });
+    return (int)regions.size() - 1;
+}
+
+int TextureAtlas::add(const char* path) {
+    int width = 0, height = 0;
+    std::vector<uint8_t> pixels;
+    if(!decode_rgba(path, width, height, pixels)) {
+        std::cerr << "Error : unable to load texture " << path << std::endl;
+        return -1;
+    }
+    return add(pixels.data(), width, height);
+}
+
+bool TextureAtlas::build() {
+    if(images.empty())
+        return false;
+
+    const int alignment = 1 << max_level;
+    const int border = alignment;
+
+    // Tall images first keep skyline flat
+    std::vector<size_t> order(images.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        if(images[a].height != images[b].height)
+            return images[a].height > images[b].height;
+        return images[a].width > images[b].width;
+    });
+
+    // Packing is done in alignment units, so all cells stay aligned
+    std::vector<SkylinePacker> pages;
+    std::vector<int> cell_x(images.size()), cell_y(images.size());
+    for(size_t index : order) {
+        const int units_width = (images[index].width + alignment - 1) / alignment + 2;
+        const int units_height = (images[index].height + alignment - 1) / alignment + 2;
+        int layer = 0;
+        for(; layer < (int)pages.size(); ++layer)
+            if(pages[layer].insert(units_width, units_height, cell_x[index], cell_y[index]))
+                break;
+        if(layer == (int)pages.size()) {
+            pages.emplace_back(page_size / alignment, page_size / alignment);
+            pages.back().insert(units_width, units_height, cell_x[index], cell_y[index]);
+        }
+        cell_x[index] *= alignment;
+        cell_y[index] *= alignment;
+        regions[index].layer = layer;
+    }
+    layers_count = (int)pages.size();
+
+    // Cells are filled with clamped image, border repeats edge pixels
+    std::vector<std::vector<uint8_t>> layer_pixels(layers_count, std::vector<uint8_t>((size_t)page_size * page_size * 4, 0));
+    for(size_t index = 0; index < images.size(); ++index) {
+        const Image& image = images[index];
+        AtlasRegion& region = regions[index];
+        const int cell_width = (image.width + alignment - 1) / alignment * alignment + border * 2;
+        const int cell_height = (image.height + alignment - 1) / alignment * alignment + border * 2;
+        uint8_t* page = layer_pixels[region.layer].data();
+        for(int y = 0; y < cell_height; ++y) {
+            const int source_y = std::min(image.height - 1, std::max(0, y - border));
+            uint32_t* row = (uint32_t*)(page + ((size_t)(cell_y[index] + y) * page_size + cell_x[index]) * 4);
+            const uint32_t* source = (const uint32_t*)(image.pixels.data() + (size_t)source_y * image.width * 4);
+            for(int x = 0; x < cell_width; ++x)
+                row[x] = source[std::min(image.width - 1, std::max(0, x - border))];
+        }
+
+        region.u0 = (float)(cell_x[index] + border) / page_size;
+        region.v0 = (float)(cell_y[index] + border) / page_size;
+        region.u1 = (float)(cell_x[index] + border + image.width) / page_size;
+        region.v1 = (float)(cell_y[index] + border + image.height) / page_size;
+    }
+    images.clear();
+    images.shrink_to_fit();
+
+    if(!texture_id)
+        glGenTextures(1, &texture_id);
+    bind_texture_direct(GL_TEXTURE_2D_ARRAY, texture_id);
+    const GLint internal_format = color_internal_format(4, srgb_color_textures());
+    for(int level = 0; level <= max_level; ++level) {
+        const int size = page_size >> level;
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, level, internal_format, size, size, layers_count, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    }
+
+    MipLevel mips[2];
+    for(int layer = 0; layer < layers_count; ++layer) {
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, page_size, page_size, 1,
+                        GL_RGBA, GL_UNSIGNED_BYTE, layer_pixels[layer].data());
+        const uint8_t* source = layer_pixels[layer].data();
+        int size = page_size;
+        for(int level = 1; level <= max_level; ++level) {
+            MipLevel& mip = mips[level % 2];
+            generate_mip(source, size, size, 4, true, MIP_FILTER_BOX, mip);
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, mip.width, mip.height, 1,
+                            GL_RGBA, GL_UNSIGNED_BYTE, mip.pixels.data());
+            source = mip.pixels.data();
+            size = mip.width;
+        }
+    }
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, max_level);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    bind_texture_direct(GL_TEXTURE_2D_ARRAY, 0);
+    return true;
+}
@@ -0,0 +1,76 @@
+#include <block_compression.h>
+#include <dds_texture.h>
+#include <mip_generator.h>
+#include <SOIL/SOIL.h>
+#include <iostream>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+// Converts image into DDS with BC1 (no alpha) or BC3 mip chain :
+// TextureCooker <input image> <output.dds> [--bc1 | --bc3] [--kaiser] [--linear]
+// Mips are filtered in linear space unless --linear says data is not sRGB color.
+int main(int argc, char** argv)
+{
+    const char* input = NULL;
+    const char* output = NULL;
+    int forced_format = -1;
+    MipFilter filter = MIP_FILTER_BOX;
+    bool srgb = true;
+    for(int i = 1; i < argc; ++i) {
+        if(strcmp(argv[i], "--kaiser") == 0)
+            filter = MIP_FILTER_KAISER;
+        else if(strcmp(argv[i], "--linear") == 0)
+            srgb = false;
+        else if(strcmp(argv[i], "--bc1") == 0)
+            forced_format = BLOCK_BC1;
+        else if(strcmp(argv[i], "--bc3") == 0)
+            forced_format = BLOCK_BC3;
+        else if(!input)
+            input = argv[i];
+        else if(!output)
+            output = argv[i];
+    }
+
+    if(!input || !output) {
+        cerr << "Usage : " << argv[0] << " <input image> <output.dds> [--bc1 | --bc3] [--kaiser] [--linear]" << endl;
+        return EXIT_FAILURE;
+    }
+
+    int width = 0, height = 0, channels = 0;
+    unsigned char* pixels = SOIL_load_image(input, &width, &height, &channels, SOIL_LOAD_RGBA);
+    if(!pixels) {
+        cerr << "Error : unable to load image " << input << endl;
+        return EXIT_FAILURE;
+    }
+    vector<MipLevel> mips;
+    generate_mip_chain(pixels, width, height, 4, srgb, filter, mips);
+
+    const BlockFormat format = forced_format >= 0 ? (BlockFormat)forced_format :
+                               channels == 4 || channels == 2 ? BLOCK_BC3 : BLOCK_BC1;
+
+    CompressedImage image;
+    image.format = block_gl_format(format);
+    size_t uncompressed_size = 0;
+    for(size_t i = 0; i <= mips.size(); ++i) {
+        const unsigned char* level_pixels = i == 0 ? pixels : mips[i - 1].pixels.data();
+        const int level_width = i == 0 ? width : mips[i - 1].width;
+        const int level_height = i == 0 ? height : mips[i - 1].height;
+
+        CompressedLevel level = { level_width, level_height, image.data.size(), compressed_size(format, level_width, level_height) };
+        image.levels.push_back(level);
+        image.data.resize(level.offset + level.size);
+        compress_image(format, level_pixels, level_width, level_height, image.data.data() + level.offset);
+        uncompressed_size += (size_t)level_width * level_height * (channels == 4 || channels == 2 ? 4 : 3);
+    }
+    SOIL_free_image_data(pixels);
+
+    if(!write_dds(output, image))
+        return EXIT_FAILURE;
+
+    cout << input << " -> " << output << " : " << (format == BLOCK_BC1 ? "BC1" : "BC3")
+         << ", " << image.levels.size() << " levels, " << image.data.size() / 1024 << " KB"
+         << " (uncompressed " << uncompressed_size / 1024 << " KB)" << endl;
+    return EXIT_SUCCESS;
+}
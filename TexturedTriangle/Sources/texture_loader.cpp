@@ -0,0 +1,257 @@
+#include <texture_loader.h>
+#include <pixel_convert.h>
+#include <gl_extensions.h>
+#include <trace.h>
+#include <state_cache.h>
+#include <SOIL/SOIL.h>
+#include <chrono>
+#include <iostream>
+#include <utility>
+
+// Gray checkerboard, 4x4 RGBA
+static void upload_placeholder() {
+    unsigned char pixels[4 * 4 * 4];
+    for(int y = 0; y < 4; ++y)
+        for(int x = 0; x < 4; ++x)
+            for(int c = 0; c < 4; ++c)
+                pixels[(y * 4 + x) * 4 + c] = c == 3 ? 255 : (x + y) % 2 ? 96 : 160;
+
+    glTexImage2D(GL_TEXTURE_2D, 0, color_internal_format(4, srgb_color_textures()), 4, 4, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    // Single level is complete with mipmap filtering of bound sampler too
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
+
+bool decode_rgba(const char* path, int& width, int& height, std::vector<uint8_t>& rgba) {
+    int channels = 0;
+    unsigned char* pixels = SOIL_load_image(path, &width, &height, &channels, SOIL_LOAD_AUTO);
+    if(!pixels)
+        return false;
+    rgba.resize((size_t)width * height * 4);
+    convert_to_rgba(pixels, channels, rgba.data(), (size_t)width * height);
+    SOIL_free_image_data(pixels);
+    return true;
+}
+
+// Texture must be bound, image is RGBA (every row is 4 byte aligned), mips are
+// levels 1.. built on CPU. Color is tagged sRGB when framebuffer is, so sampling filters in linear space.
+// Returns false when uploader has no free staging buffer.
+static bool upload_image(const uint8_t* pixels, int width, int height, const std::vector<MipLevel>& mips,
+                         PixelUploader* uploader = NULL) {
+    std::vector<PixelLevel> levels;
+    levels.push_back({ width, height, pixels, (GLsizeiptr)width * height * 4 });
+    for(const MipLevel& mip : mips)
+        levels.push_back({ mip.width, mip.height, mip.pixels.data(), (GLsizeiptr)mip.pixels.size() });
+
+    const GLint internal_format = color_internal_format(4, srgb_color_textures());
+    if(uploader) {
+        if(!uploader->upload(internal_format, GL_RGBA, GL_UNSIGNED_BYTE, levels.data(), (unsigned int)levels.size()))
+            return false;
+    } else {
+        for(size_t level = 0; level < levels.size(); ++level)
+            glTexImage2D(GL_TEXTURE_2D, (GLint)level, internal_format, levels[level].width, levels[level].height, 0,
+                         GL_RGBA, GL_UNSIGNED_BYTE, levels[level].pixels);
+    }
+    // Downgraded textures are reloaded with raised base level
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)mips.size());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    return true;
+}
+
+bool s3tc_supported() {
+    static int supported = -1;
+    if(supported < 0)
+        supported = has_gl_extension("GL_EXT_texture_compression_s3tc") ? 1 : 0;
+    return supported == 1;
+}
+
+GLenum srgb_compressed_format(GLenum format) {
+    switch(format) {
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
+    case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+    case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+        return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+    }
+    return format;
+}
+
+void upload_compressed(const CompressedImage& image) {
+    const GLenum format = srgb_color_textures() ? srgb_compressed_format(image.format) : image.format;
+    for(size_t level = 0; level < image.levels.size(); ++level) {
+        const CompressedLevel& info = image.levels[level];
+        glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, format, info.width, info.height, 0,
+                               (GLsizei)info.size, image.data.data() + info.offset);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)image.levels.size() - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    image.levels.size() > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+
+// Compressed mip chain is read here, decoding into RGBA is left to SOIL
+static bool use_compressed(const std::string& path) {
+    return is_dds_path(path) && s3tc_supported();
+}
+
+GLuint load_texture(const char* path) {
+    TRACE_SCOPE("load texture");
+    // DDS files read_dds() rejects (uncompressed, DX10 header) are decoded by SOIL
+    CompressedImage image;
+    if(use_compressed(path) && read_dds(path, image)) {
+        GLuint texture_id;
+        glGenTextures(1, &texture_id);
+        bind_texture_direct(GL_TEXTURE_2D, texture_id);
+        upload_compressed(image);
+        bind_texture_direct(GL_TEXTURE_2D, 0);
+        return texture_id;
+    }
+
+    int width = 0, height = 0;
+    std::vector<uint8_t> pixels;
+    if(!decode_rgba(path, width, height, pixels)) {
+        std::cerr << "Error : unable to load texture " << path << std::endl;
+        return 0;
+    }
+
+    std::vector<MipLevel> mips;
+    generate_mip_chain(pixels.data(), width, height, 4, true, MIP_FILTER_BOX, mips);
+
+    GLuint texture_id;
+    glGenTextures(1, &texture_id);
+    bind_texture_direct(GL_TEXTURE_2D, texture_id);
+    upload_image(pixels.data(), width, height, mips);
+    bind_texture_direct(GL_TEXTURE_2D, 0);
+    return texture_id;
+}
+
+TextureLoader::TextureLoader(unsigned int threads, PixelUploader* uploader)
+    : pending_count(0), stopping(false), uploader(uploader) {
+    if(threads == 0) {
+        const unsigned int hardware = std::thread::hardware_concurrency();
+        threads = hardware > 1 ? hardware - 1 : 1;
+    }
+    for(unsigned int i = 0; i < threads; ++i)
+        workers.emplace_back(&TextureLoader::work, this);
+}
+
+TextureLoader::~TextureLoader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        requests.clear();
+    }
+    condition.notify_all();
+    for(std::thread& worker : workers)
+        worker.join();
+}
+
+void TextureLoader::work() {
+    trace_thread_name("texture loader");
+    for(;;) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] { return stopping || !requests.empty(); });
+            if(stopping)
+                return;
+            request = requests.front();
+            requests.pop_front();
+        }
+
+        // Decoding is the slow part and needs no GL context
+        TRACE_SCOPE("decode texture");
+        Image image = { request.texture_id, {}, 0, 0, request.path, request.compressed, CompressedImage(), {} };
+        // DDS files read_dds() rejects are decoded by SOIL like other images
+        if(request.compressed && !read_dds(request.path.c_str(), image.blocks))
+            image.compressed = false;
+        if(!image.compressed && decode_rgba(request.path.c_str(), image.width, image.height, image.pixels)) {
+            // Workers already run in parallel, so mips use one thread each
+            generate_mip_chain(image.pixels.data(), image.width, image.height, 4, true, MIP_FILTER_BOX, image.mips, 1);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        decoded.push_back(std::move(image));
+    }
+}
+
+GLuint TextureLoader::load(const char* path) {
+    GLuint texture_id;
+    glGenTextures(1, &texture_id);
+    bind_texture_direct(GL_TEXTURE_2D, texture_id);
+    upload_placeholder();
+    bind_texture_direct(GL_TEXTURE_2D, 0);
+    reload(texture_id, path);
+    return texture_id;
+}
+
+void TextureLoader::reload(GLuint texture_id, const char* path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests.push_back({ path, texture_id, use_compressed(path) });
+    }
+    condition.notify_one();
+    ++pending_count;
+}
+
+unsigned int TextureLoader::update(double budget, std::vector<GLuint>* finished) {
+    TRACE_SCOPE("upload textures");
+    auto start = std::chrono::steady_clock::now();
+    unsigned int uploaded = 0;
+
+    for(;;) {
+        if(uploaded > 0 && std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= budget)
+            break;
+
+        Image image;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(decoded.empty())
+                break;
+            image = std::move(decoded.front());
+            decoded.pop_front();
+        }
+
+        if(image.compressed) {
+            bind_texture_direct(GL_TEXTURE_2D, image.texture_id);
+            upload_compressed(image.blocks);
+            bind_texture_direct(GL_TEXTURE_2D, 0);
+            --pending_count;
+            ++uploaded;
+            if(finished)
+                finished->push_back(image.texture_id);
+            continue;
+        }
+
+        if(image.pixels.empty()) {
+            // Texture keeps placeholder
+            std::cerr << "Error : unable to load texture " << image.path << std::endl;
+            --pending_count;
+            if(finished)
+                finished->push_back(image.texture_id);
+            continue;
+        }
+
+        bind_texture_direct(GL_TEXTURE_2D, image.texture_id);
+        const bool done = upload_image(image.pixels.data(), image.width, image.height, image.mips, uploader);
+        bind_texture_direct(GL_TEXTURE_2D, 0);
+        if(!done) {
+            // Staging buffers are busy, retry next frame
+            std::lock_guard<std::mutex> lock(mutex);
+            decoded.push_front(std::move(image));
+            break;
+        }
+        --pending_count;
+        ++uploaded;
+        if(finished)
+            finished->push_back(image.texture_id);
+    }
+    return uploaded;
+}
@@ -0,0 +1,161 @@
+#include <texture_manager.h>
+#include <state_cache.h>
+#include <algorithm>
+
+// Textures of this size and smaller are evicted instead of downgraded
+static const GLint min_downgrade_size = 64;
+
+// Uncompressed formats, drivers keep 3 channel textures as 4 channels
+static size_t texel_bytes(GLint internal_format) {
+    switch(internal_format) {
+    case GL_R8:
+        return 1;
+    case GL_RG8:
+        return 2;
+    case GL_RGBA16F:
+        return 8;
+    case GL_RGBA32F:
+        return 16;
+    }
+    return 4;
+}
+
+size_t texture_bytes() {
+    GLint base_level = 0, max_level = 0;
+    glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, &base_level);
+    glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, &max_level);
+    size_t bytes = 0;
+    for(GLint level = base_level; level <= max_level; ++level) {
+        GLint width = 0, height = 0, compressed = 0;
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_WIDTH, &width);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_HEIGHT, &height);
+        if(width == 0 || height == 0)
+            break;
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_COMPRESSED, &compressed);
+        if(compressed) {
+            GLint size = 0;
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+            bytes += size;
+        } else {
+            GLint internal_format = 0;
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_INTERNAL_FORMAT, &internal_format);
+            bytes += (size_t)width * height * texel_bytes(internal_format);
+        }
+    }
+    return bytes;
+}
+
+TextureManager::TextureManager(TextureLoader& loader, size_t budget_bytes)
+    : loader(loader), budget_bytes(budget_bytes), frame(1), usage_bytes(0),
+      evictions_count(0), downgrades_count(0), reloads_count(0) {}
+
+TextureManager::~TextureManager() {
+    for(Entry& entry : entries)
+        if(entry.texture_id)
+            glDeleteTextures(1, &entry.texture_id);
+}
+
+void TextureManager::measure(Entry& entry) {
+    bind_texture_direct(GL_TEXTURE_2D, entry.texture_id);
+    const size_t bytes = texture_bytes();
+    bind_texture_direct(GL_TEXTURE_2D, 0);
+    usage_bytes = usage_bytes - entry.bytes + bytes;
+    entry.bytes = bytes;
+}
+
+TextureHandle TextureManager::add(const char* path) {
+    auto found = handles.find(path);
+    if(found != handles.end())
+        return found->second;
+
+    entries.push_back({ path, loader.load(path), STATE_LOADING, 0, frame, 0 });
+    measure(entries.back());
+    handles[path] = entries.size() - 1;
+    return entries.size() - 1;
+}
+
+GLuint TextureManager::use(TextureHandle handle) {
+    Entry& entry = entries[handle];
+    entry.last_used = frame;
+    if(entry.state == STATE_EVICTED) {
+        entry.texture_id = loader.load(entry.path.c_str());
+        entry.state = STATE_LOADING;
+        measure(entry);
+        ++reloads_count;
+    } else if(entry.state == STATE_DOWNGRADED) {
+        // Lower levels are drawn until full image is uploaded
+        loader.reload(entry.texture_id, entry.path.c_str());
+        entry.state = STATE_LOADING;
+        ++reloads_count;
+    }
+    return entry.texture_id;
+}
+
+// Top level is dropped on GPU : base level moves one level down and old top
+// level is respecified empty, which frees its memory. Nothing is read back,
+// so GPU keeps running ahead. Reload uploads whole chain and resets base level.
+bool TextureManager::downgrade(Entry& entry) {
+    bind_texture_direct(GL_TEXTURE_2D, entry.texture_id);
+    GLint base_level = 0, max_level = 0, width = 0, height = 0, internal_format = 0, compressed = 0;
+    glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, &base_level);
+    glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, &max_level);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, base_level, GL_TEXTURE_WIDTH, &width);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, base_level, GL_TEXTURE_HEIGHT, &height);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, base_level, GL_TEXTURE_INTERNAL_FORMAT, &internal_format);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, base_level, GL_TEXTURE_COMPRESSED, &compressed);
+    if(std::max(width, height) <= min_downgrade_size || base_level >= max_level) {
+        bind_texture_direct(GL_TEXTURE_2D, 0);
+        return false;
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, base_level + 1);
+    if(compressed)
+        glCompressedTexImage2D(GL_TEXTURE_2D, base_level, internal_format, 0, 0, 0, 0, NULL);
+    else
+        glTexImage2D(GL_TEXTURE_2D, base_level, internal_format, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    bind_texture_direct(GL_TEXTURE_2D, 0);
+
+    entry.state = STATE_DOWNGRADED;
+    entry.downgraded_frame = frame;
+    measure(entry);
+    ++downgrades_count;
+    return true;
+}
+
+void TextureManager::evict(Entry& entry) {
+    glDeleteTextures(1, &entry.texture_id);
+    entry.texture_id = 0;
+    entry.state = STATE_EVICTED;
+    usage_bytes -= entry.bytes;
+    entry.bytes = 0;
+    ++evictions_count;
+}
+
+void TextureManager::update(double upload_budget) {
+    finished.clear();
+    loader.update(upload_budget, &finished);
+    for(GLuint texture_id : finished) {
+        for(Entry& entry : entries) {
+            if(entry.texture_id == texture_id && entry.state == STATE_LOADING) {
+                entry.state = STATE_RESIDENT;
+                measure(entry);
+                break;
+            }
+        }
+    }
+
+    // Loading textures are skipped, loader still writes into them. Texture is
+    // downgraded at most once per frame, rest of excess waits for next frame.
+    while(usage_bytes > budget_bytes) {
+        Entry* victim = NULL;
+        for(Entry& entry : entries)
+            if((entry.state == STATE_RESIDENT || entry.state == STATE_DOWNGRADED) && entry.last_used < frame &&
+               entry.downgraded_frame < frame && (!victim || entry.last_used < victim->last_used))
+                victim = &entry;
+        if(!victim)
+            break;
+        if(!downgrade(*victim))
+            evict(*victim);
+    }
+    ++frame;
+}
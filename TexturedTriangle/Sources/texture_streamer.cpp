@@ -0,0 +1,260 @@
+#include <texture_streamer.h>
+#include <texture_loader.h>
+#include <pixel_convert.h>
+#include <dds_texture.h>
+#include <trace.h>
+#include <state_cache.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <utility>
+
+TextureStreamer::TextureStreamer(size_t frame_budget, int initial_size)
+    : frame_budget(frame_budget), initial_size(initial_size), uploaded_bytes(0), stopping(false) {
+    worker = std::thread(&TextureStreamer::work, this);
+}
+
+TextureStreamer::~TextureStreamer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        requests.clear();
+    }
+    condition.notify_all();
+    worker.join();
+
+    for(Texture& texture : textures)
+        glDeleteTextures(1, &texture.texture_id);
+}
+
+void TextureStreamer::work() {
+    trace_thread_name("texture streamer");
+    for(;;) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] { return stopping || !requests.empty(); });
+            if(stopping)
+                return;
+            request = requests.front();
+            requests.pop_front();
+        }
+
+        // Whole chain is kept on CPU, only GPU side is streamed
+        TRACE_SCOPE("decode texture");
+        Decoded image = { request.index, request.compressed, 0, {} };
+        if(request.compressed) {
+            CompressedImage blocks;
+            if(read_dds(request.path.c_str(), blocks)) {
+                image.internal_format = srgb_color_textures() ? srgb_compressed_format(blocks.format) : blocks.format;
+                for(const CompressedLevel& level : blocks.levels) {
+                    const unsigned char* data = blocks.data.data() + level.offset;
+                    image.levels.push_back({ level.width, level.height, std::vector<uint8_t>(data, data + level.size) });
+                }
+            } else {
+                // Rejected DDS files are decoded by SOIL like other images
+                image.compressed = false;
+            }
+        }
+        if(!image.compressed) {
+            MipLevel top;
+            if(decode_rgba(request.path.c_str(), top.width, top.height, top.pixels)) {
+                image.internal_format = color_internal_format(4, srgb_color_textures());
+                std::vector<MipLevel> mips;
+                generate_mip_chain(top.pixels.data(), top.width, top.height, 4, true, MIP_FILTER_BOX, mips);
+                image.levels.push_back(std::move(top));
+                for(MipLevel& mip : mips)
+                    image.levels.push_back(std::move(mip));
+            }
+        }
+        if(image.levels.empty())
+            std::cerr << "Error : unable to load texture " << request.path << std::endl;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        decoded.push_back(std::move(image));
+    }
+}
+
+size_t TextureStreamer::add(const char* path) {
+    GLuint texture_id;
+    glGenTextures(1, &texture_id);
+    bind_texture_direct(GL_TEXTURE_2D, texture_id);
+    const unsigned char gray[4] = { 128, 128, 128, 255 };
+    glTexImage2D(GL_TEXTURE_2D, 0, color_internal_format(4, srgb_color_textures()), 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, gray);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    bind_texture_direct(GL_TEXTURE_2D, 0);
+
+    textures.push_back({ texture_id, 0, false, {}, 0, 0.0f, 0 });
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests.push_back({ textures.size() - 1, path, is_dds_path(path) && s3tc_supported() });
+    }
+    condition.notify_one();
+    return textures.size() - 1;
+}
+
+void TextureStreamer::request(size_t index, float screen_size) {
+    textures[index].screen_size = screen_size;
+}
+
+// Smallest level still covering on-screen size, texture without request keeps its levels
+static int wanted_level(const std::vector<MipLevel>& levels, int resident_level, float screen_size) {
+    if(screen_size <= 0.0f)
+        return std::min(resident_level, (int)levels.size() - 1);
+    const int size = std::max(levels[0].width, levels[0].height);
+    const float ratio = size / std::max(1.0f, screen_size);
+    const int level = ratio > 1.0f ? (int)std::floor(std::log2(ratio)) : 0;
+    return std::min(level, (int)levels.size() - 1);
+}
+
+static void upload_level(const MipLevel& level, GLint level_index, GLint internal_format, bool compressed) {
+    if(compressed)
+        glCompressedTexImage2D(GL_TEXTURE_2D, level_index, internal_format, level.width, level.height, 0,
+                               (GLsizei)level.pixels.size(), level.pixels.data());
+    else
+        glTexImage2D(GL_TEXTURE_2D, level_index, internal_format, level.width, level.height, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, level.pixels.data());
+}
+
+// Levels up to initial size are uploaded whole, texture is sampled from them at once
+void TextureStreamer::start(Texture& texture, Decoded& image) {
+    texture.levels = std::move(image.levels);
+    texture.internal_format = image.internal_format;
+    texture.compressed = image.compressed;
+    texture.resident_level = (int)texture.levels.size();
+    if(texture.levels.empty())
+        return;
+
+    int first = (int)texture.levels.size() - 1;
+    while(first > 0 && std::max(texture.levels[first - 1].width, texture.levels[first - 1].height) <= initial_size)
+        --first;
+
+    bind_texture_direct(GL_TEXTURE_2D, texture.texture_id);
+    for(int level = first; level < (int)texture.levels.size(); ++level) {
+        upload_level(texture.levels[level], level, texture.internal_format, texture.compressed);
+        uploaded_bytes += texture.levels[level].pixels.size();
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, first);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)texture.levels.size() - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    bind_texture_direct(GL_TEXTURE_2D, 0);
+    texture.resident_level = first;
+}
+
+// Next band of rows of level resident_level - 1, level becomes base when complete
+size_t TextureStreamer::stream(Texture& texture, size_t budget) {
+    const int level_index = texture.resident_level - 1;
+    const MipLevel& level = texture.levels[level_index];
+    bind_texture_direct(GL_TEXTURE_2D, texture.texture_id);
+    if(texture.streamed_rows == 0) {
+        // Storage only, base level keeps sampling away from it
+        if(texture.compressed)
+            glCompressedTexImage2D(GL_TEXTURE_2D, level_index, texture.internal_format, level.width, level.height, 0,
+                                   (GLsizei)level.pixels.size(), NULL);
+        else
+            glTexImage2D(GL_TEXTURE_2D, level_index, texture.internal_format, level.width, level.height, 0,
+                         GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    }
+
+    // Compressed rows go in whole blocks
+    const int row_unit = texture.compressed ? 4 : 1;
+    const size_t units = (level.height + row_unit - 1) / row_unit;
+    const size_t unit_bytes = level.pixels.size() / units;
+    const int first_row = texture.streamed_rows;
+    const int rows = (int)std::min<size_t>(level.height - first_row, std::max<size_t>(1, budget / unit_bytes) * row_unit);
+    const size_t offset = first_row / row_unit * unit_bytes;
+    const size_t bytes = std::min(level.pixels.size() - offset, (rows + row_unit - 1) / row_unit * unit_bytes);
+    if(texture.compressed)
+        glCompressedTexSubImage2D(GL_TEXTURE_2D, level_index, 0, first_row, level.width, rows, texture.internal_format,
+                                  (GLsizei)bytes, level.pixels.data() + offset);
+    else
+        glTexSubImage2D(GL_TEXTURE_2D, level_index, 0, first_row, level.width, rows,
+                        GL_RGBA, GL_UNSIGNED_BYTE, level.pixels.data() + offset);
+
+    texture.streamed_rows += rows;
+    if(texture.streamed_rows >= level.height) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level_index);
+        texture.resident_level = level_index;
+        texture.streamed_rows = 0;
+    }
+    bind_texture_direct(GL_TEXTURE_2D, 0);
+    return bytes;
+}
+
+// Levels finer than level are freed by respecifying them empty
+void TextureStreamer::release(Texture& texture, int level) {
+    const int first = texture.resident_level - (texture.streamed_rows > 0 ? 1 : 0);
+    bind_texture_direct(GL_TEXTURE_2D, texture.texture_id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+    for(int freed = first; freed < level; ++freed) {
+        if(texture.compressed)
+            glCompressedTexImage2D(GL_TEXTURE_2D, freed, texture.internal_format, 0, 0, 0, 0, NULL);
+        else
+            glTexImage2D(GL_TEXTURE_2D, freed, texture.internal_format, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    }
+    bind_texture_direct(GL_TEXTURE_2D, 0);
+    texture.resident_level = level;
+    texture.streamed_rows = 0;
+}
+
+size_t TextureStreamer::update() {
+    uploaded_bytes = 0;
+
+    std::deque<Decoded> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.swap(decoded);
+    }
+    for(Decoded& image : ready)
+        start(textures[image.index], image);
+
+    // One level of hysteresis, so size changing around level boundary does not thrash
+    for(Texture& texture : textures) {
+        if(texture.levels.empty())
+            continue;
+        const int wanted = wanted_level(texture.levels, texture.resident_level, texture.screen_size);
+        if(wanted > texture.resident_level + 1)
+            release(texture, wanted - 1);
+    }
+
+    // Level in progress is finished first, then texture furthest from its wanted level
+    while(uploaded_bytes < frame_budget) {
+        Texture* next = NULL;
+        int next_gap = 0;
+        for(Texture& texture : textures) {
+            if(texture.levels.empty())
+                continue;
+            const int gap = texture.resident_level - wanted_level(texture.levels, texture.resident_level, texture.screen_size);
+            if(texture.streamed_rows > 0 && gap > 0) {
+                next = &texture;
+                break;
+            }
+            if(gap > next_gap) {
+                next = &texture;
+                next_gap = gap;
+            }
+        }
+        if(!next)
+            break;
+        uploaded_bytes += stream(*next, frame_budget - uploaded_bytes);
+    }
+    return uploaded_bytes;
+}
+
+size_t TextureStreamer::resident_bytes() const {
+    size_t bytes = 0;
+    for(const Texture& texture : textures)
+        for(size_t level = texture.resident_level; level < texture.levels.size(); ++level)
+            bytes += texture.levels[level].pixels.size();
+    return bytes;
+}
+
+size_t TextureStreamer::streaming() const {
+    size_t count = 0;
+    for(const Texture& texture : textures)
+        if(texture.levels.empty() || texture.resident_level > wanted_level(texture.levels, texture.resident_level, texture.screen_size))
+            ++count;
+    return count;
+}
@@ -0,0 +1,170 @@
+#include <trace.h>
+#include <fstream>
+#include <iostream>   // cerr
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+std::atomic<bool> trace_enabled(false);
+
+typedef std::chrono::steady_clock Clock;
+
+namespace {
+
+struct Event {
+    const char* name;
+    uint64_t    begin;
+    uint64_t    end;
+};
+
+// Written only by owner thread, count is published after event is stored,
+// dropped is read by trace_write() while owner may still record
+struct ThreadBuffer {
+    static const size_t capacity = 1 << 16;
+
+    unsigned int        id;
+    std::string         name;
+    std::atomic<size_t> count;
+    std::atomic<size_t> dropped;
+    Event               events[capacity];
+
+    // Pages are touched here, not by first events of recorded scopes
+    explicit ThreadBuffer(unsigned int thread_id) :
+        id(thread_id), name("thread " + std::to_string(thread_id)), count(0), dropped(0), events() {
+    }
+};
+
+// Span in CPU nanoseconds since trace start
+struct GpuSpan {
+    const char* name;
+    int64_t     begin;
+    int64_t     end;
+};
+
+std::mutex                                 trace_mutex;
+std::vector<std::unique_ptr<ThreadBuffer>> buffers;     // Outlive threads, read on write
+std::vector<GpuSpan>                       gpu_spans;
+uint64_t                                   start_ticks = 0;
+Clock::time_point                          start_time;
+int64_t                                    gpu_offset = 0;  // CPU ns since start minus GPU ns
+bool                                       gpu_synced = false;
+
+thread_local ThreadBuffer* thread_buffer = NULL;
+
+ThreadBuffer* current_buffer() {
+    if(!thread_buffer) {
+        std::lock_guard<std::mutex> lock(trace_mutex);
+        buffers.emplace_back(new ThreadBuffer((unsigned int)buffers.size() + 1));
+        thread_buffer = buffers.back().get();
+    }
+    return thread_buffer;
+}
+
+int64_t nanoseconds_since_start() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_time).count();
+}
+
+}
+
+void trace_start() {
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    start_time = Clock::now();
+    start_ticks = trace_clock();
+    trace_enabled.store(true, std::memory_order_relaxed);
+}
+
+void trace_thread_name(const char* name) {
+    if(!trace_enabled.load(std::memory_order_relaxed))
+        return;
+    ThreadBuffer* buffer = current_buffer();
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    buffer->name = name;
+}
+
+void trace_record(const char* name, uint64_t begin, uint64_t end) {
+    ThreadBuffer* buffer = current_buffer();
+    const size_t index = buffer->count.load(std::memory_order_relaxed);
+    if(index == ThreadBuffer::capacity) {
+        buffer->dropped.store(buffer->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->events[index] = { name, begin, end };
+    buffer->count.store(index + 1, std::memory_order_release);
+}
+
+void trace_sync_gpu_clock(int64_t gpu_time) {
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    gpu_offset = nanoseconds_since_start() - gpu_time;
+    gpu_synced = true;
+}
+
+void trace_gpu_span(const char* name, uint64_t begin, uint64_t end) {
+    if(!trace_enabled.load(std::memory_order_relaxed))
+        return;
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    if(gpu_synced)
+        gpu_spans.push_back({ name, (int64_t)begin + gpu_offset, (int64_t)end + gpu_offset });
+}
+
+// Chrome trace timestamps are microseconds
+static void write_event(std::ofstream& file, bool& first, const char* name, unsigned int tid, double begin, double end) {
+    file << (first ? "\n" : ",\n")
+         << "{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+         << ",\"ts\":" << begin * 1e-3 << ",\"dur\":" << (end - begin) * 1e-3 << "}";
+    first = false;
+}
+
+static void write_track_name(std::ofstream& file, bool& first, unsigned int tid, const std::string& name) {
+    file << (first ? "\n" : ",\n")
+         << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+         << ",\"args\":{\"name\":\"" << name << "\"}}";
+    first = false;
+}
+
+bool trace_write(const char* path) {
+    std::ofstream file(path);
+    if(!file) {
+        std::cerr << "Error : failed to write trace " << path << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(trace_mutex);
+
+    // Event ticks to nanoseconds since start, rate measured over whole trace
+    const double elapsed = (double)nanoseconds_since_start();
+    const uint64_t ticks = trace_clock() - start_ticks;
+    const double ns_per_tick = ticks > 0 ? elapsed / ticks : 1.0;
+
+    file << std::fixed;
+    file.precision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+
+    // GPU track is tid 0, above CPU threads
+    write_track_name(file, first, 0, "GPU");
+    for(const GpuSpan& span : gpu_spans)
+        write_event(file, first, span.name, 0, (double)span.begin, (double)span.end);
+
+    size_t events = gpu_spans.size(), dropped = 0;
+    for(const std::unique_ptr<ThreadBuffer>& buffer : buffers) {
+        write_track_name(file, first, buffer->id, buffer->name);
+        const size_t count = buffer->count.load(std::memory_order_acquire);
+        for(size_t i = 0; i < count; ++i) {
+            const Event& event = buffer->events[i];
+            if(event.begin < start_ticks)
+                continue;
+            write_event(file, first, event.name, buffer->id,
+                        (event.begin - start_ticks) * ns_per_tick, (event.end - start_ticks) * ns_per_tick);
+        }
+        events += count;
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    file << "\n]}\n";
+
+    std::cout << "Trace written : " << path << ", " << events << " events";
+    if(dropped)
+        std::cout << ", " << dropped << " dropped";
+    std::cout << std::endl;
+    return true;
+}
@@ -0,0 +1,234 @@
+#include <vertex_format.h>
+#include <gl_extensions.h>
+#include <cstring>    // memcpy
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <immintrin.h>
+#define VERTEX_FORMAT_SSE2
+#if defined(__GNUC__) || defined(__clang__)
+#define VERTEX_FORMAT_F16C
+#endif
+#endif
+
+struct FormatInfo {
+    GLint     components;
+    GLenum    type;
+    GLboolean normalized;
+    GLuint    size;
+};
+
+static FormatInfo format_info(VertexAttributeFormat format) {
+    switch(format) {
+    case FORMAT_FLOAT2:             return { 2, GL_FLOAT,                GL_FALSE, 8  };
+    case FORMAT_FLOAT3:             return { 3, GL_FLOAT,                GL_FALSE, 12 };
+    case FORMAT_FLOAT4:             return { 4, GL_FLOAT,                GL_FALSE, 16 };
+    case FORMAT_HALF2:              return { 2, GL_HALF_FLOAT,           GL_FALSE, 4  };
+    case FORMAT_HALF4:              return { 4, GL_HALF_FLOAT,           GL_FALSE, 8  };
+    case FORMAT_UNORM8x4:           return { 4, GL_UNSIGNED_BYTE,        GL_TRUE,  4  };
+    case FORMAT_UNORM16x2:          return { 2, GL_UNSIGNED_SHORT,       GL_TRUE,  4  };
+    case FORMAT_SNORM_2_10_10_10:   return { 4, GL_INT_2_10_10_10_REV,   GL_TRUE,  4  };
+    }
+    return { 4, GL_FLOAT, GL_FALSE, 16 };
+}
+
+GLuint format_size(VertexAttributeFormat format) {
+    return format_info(format).size;
+}
+
+GLint format_components(VertexAttributeFormat format) {
+    return format_info(format).components;
+}
+
+VertexFormat& VertexFormat::add(GLuint location, VertexAttributeFormat format) {
+    attributes.push_back({ location, format, stride });
+    stride += format_size(format);
+    return *this;
+}
+
+void VertexFormat::apply(size_t base_offset) const {
+    for(const VertexFormatAttribute& attribute : attributes) {
+        FormatInfo info = format_info(attribute.format);
+        glEnableVertexAttribArray(attribute.location);
+        glVertexAttribPointer(
+            attribute.location,
+            info.components,
+            info.type,
+            info.normalized,
+            stride,
+            (GLvoid*)(base_offset + attribute.offset)
+        );
+    }
+}
+
+void VertexFormat::pack(const VertexSource* sources, size_t vertices, void* destination) const {
+    // Attributes are converted in chunks : gather floats, run kernel, scatter
+    const size_t chunk_size = 256;
+    float   gathered[chunk_size * 4];
+    uint8_t converted[chunk_size * 16];
+    uint8_t* output = (uint8_t*)destination;
+
+    for(size_t i = 0; i < attributes.size(); ++i) {
+        const VertexFormatAttribute& attribute = attributes[i];
+        const VertexSource& source = sources[i];
+        const FormatInfo info = format_info(attribute.format);
+        const GLuint components = (GLuint)info.components;
+
+        for(size_t first = 0; first < vertices; first += chunk_size) {
+            const size_t count = vertices - first < chunk_size ? vertices - first : chunk_size;
+
+            for(size_t v = 0; v < count; ++v) {
+                const float* vertex = source.data + (first + v) * source.stride;
+                for(GLuint c = 0; c < components; ++c)
+                    gathered[v * components + c] = c < source.components ? vertex[c] : (c == 3 ? 1.0f : 0.0f);
+            }
+
+            switch(attribute.format) {
+            case FORMAT_FLOAT2:
+            case FORMAT_FLOAT3:
+            case FORMAT_FLOAT4:
+                memcpy(converted, gathered, count * info.size);
+                break;
+            case FORMAT_HALF2:
+            case FORMAT_HALF4:
+                pack_half(gathered, (uint16_t*)converted, count * components);
+                break;
+            case FORMAT_UNORM8x4:
+                pack_unorm8(gathered, converted, count * components);
+                break;
+            case FORMAT_UNORM16x2:
+                pack_unorm16(gathered, (uint16_t*)converted, count * components);
+                break;
+            case FORMAT_SNORM_2_10_10_10:
+                pack_snorm_2_10_10_10(gathered, (uint32_t*)converted, count, gl_extensions.snorm_gl42);
+                break;
+            }
+
+            for(size_t v = 0; v < count; ++v)
+                memcpy(output + (first + v) * stride + attribute.offset, converted + v * info.size, info.size);
+        }
+    }
+}
+
+static inline float clamp(float value, float low, float high) {
+    return value < low ? low : (value > high ? high : value);
+}
+
+// Round to nearest even, overflow gives infinity, small values - subnormals
+static uint16_t float_to_half(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const uint32_t float_exponent = (bits >> 23) & 0xff;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    if(float_exponent == 0xff)                              // Inf, NaN
+        return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+
+    const int32_t exponent = (int32_t)float_exponent - 127 + 15;
+    if(exponent >= 31)
+        return sign | 0x7c00;
+
+    if(exponent <= 0) {
+        if(exponent < -10)
+            return sign;
+        mantissa |= 0x800000;
+        const uint32_t shift = 14 - exponent;
+        uint32_t half = mantissa >> shift;
+        const uint32_t remainder = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        if(remainder > halfway || (remainder == halfway && (half & 1)))
+            ++half;
+        return sign | half;
+    }
+
+    // Rounding carry may move value to next exponent, this is still correct
+    uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+    const uint32_t remainder = mantissa & 0x1fff;
+    if(remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+        ++half;
+    return (uint16_t)half;
+}
+
+#ifdef VERTEX_FORMAT_F16C
+__attribute__((target("f16c")))
+static size_t pack_half_f16c(const float* source, uint16_t* destination, size_t count) {
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        __m256 values = _mm256_loadu_ps(source + i);
+        _mm_storeu_si128((__m128i*)(destination + i), _mm256_cvtps_ph(values, _MM_FROUND_TO_NEAREST_INT));
+    }
+    return i;
+}
+#endif
+
+void pack_half(const float* source, uint16_t* destination, size_t count) {
+    size_t i = 0;
+#ifdef VERTEX_FORMAT_F16C
+    static const bool has_f16c = __builtin_cpu_supports("f16c");
+    if(has_f16c)
+        i = pack_half_f16c(source, destination, count);
+#endif
+    for(; i < count; ++i)
+        destination[i] = float_to_half(source[i]);
+}
+
+void pack_unorm8(const float* source, uint8_t* destination, size_t count) {
+    size_t i = 0;
+#ifdef VERTEX_FORMAT_SSE2
+    const __m128 zero  = _mm_setzero_ps();
+    const __m128 one   = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(255.0f);
+    for(; i + 16 <= count; i += 16) {
+        __m128i a = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i),      zero), one), scale));
+        __m128i b = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i + 4),  zero), one), scale));
+        __m128i c = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i + 8),  zero), one), scale));
+        __m128i d = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i + 12), zero), one), scale));
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        _mm_storeu_si128((__m128i*)(destination + i), packed);
+    }
+#endif
+    for(; i < count; ++i)
+        destination[i] = (uint8_t)(clamp(source[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+void pack_unorm16(const float* source, uint16_t* destination, size_t count) {
+    size_t i = 0;
+#ifdef VERTEX_FORMAT_SSE2
+    // SSE2 has signed saturation only : shift range to int16, pack, shift back
+    const __m128  zero  = _mm_setzero_ps();
+    const __m128  one   = _mm_set1_ps(1.0f);
+    const __m128  scale = _mm_set1_ps(65535.0f);
+    const __m128i bias  = _mm_set1_epi32(32768);
+    const __m128i flip  = _mm_set1_epi16((short)0x8000);
+    for(; i + 8 <= count; i += 8) {
+        __m128i a = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i),     zero), one), scale));
+        __m128i b = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i + 4), zero), one), scale));
+        __m128i packed = _mm_packs_epi32(_mm_sub_epi32(a, bias), _mm_sub_epi32(b, bias));
+        _mm_storeu_si128((__m128i*)(destination + i), _mm_xor_si128(packed, flip));
+    }
+#endif
+    for(; i < count; ++i)
+        destination[i] = (uint16_t)(clamp(source[i], 0.0f, 1.0f) * 65535.0f + 0.5f);
+}
+
+static inline int32_t round_to_int(float value) {
+    return (int32_t)(value < 0.0f ? value - 0.5f : value + 0.5f);
+}
+
+// Signed normalized value of bits wide field
+static inline uint32_t pack_snorm(float value, int bits, bool gl42_rule) {
+    const float max_code = (float)((1 << (bits - 1)) - 1);
+    value = clamp(value, -1.0f, 1.0f);
+    const int32_t code = gl42_rule ? round_to_int(value * max_code) :
+                                     round_to_int((value * (2.0f * max_code + 1.0f) - 1.0f) * 0.5f);
+    return (uint32_t)code & ((1u << bits) - 1);
+}
+
+void pack_snorm_2_10_10_10(const float* source_xyzw, uint32_t* destination, size_t vectors, bool gl42_rule) {
+    for(size_t i = 0; i < vectors; ++i) {
+        const float* v = source_xyzw + i * 4;
+        destination[i] = pack_snorm(v[0], 10, gl42_rule) | pack_snorm(v[1], 10, gl42_rule) << 10 |
+                         pack_snorm(v[2], 10, gl42_rule) << 20 | pack_snorm(v[3], 2, gl42_rule) << 30;
+    }
+}
@@ -41,4 +41,9 @@ echo "Project configuration : ${CONFIG}"
 cd ${BIN_DIR}
 cmake ${PROJECT_DIR} -DCONFIG=${CONFIG} && make -j${MAKE_THREADS}
 cp -v ${PROJECT_DIR}/Textures/* ${BIN_DIR}/${CONFIG}/Bin
+
+for TEXTURE in ${PROJECT_DIR}/Textures/*.jpg
+do
+    ${BIN_DIR}/${CONFIG}/Bin/TextureCooker ${TEXTURE} ${BIN_DIR}/${CONFIG}/Bin/$(basename ${TEXTURE} .jpg).dds
+done
 cd ${CURR_DIR}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <chrono>
+
+enum SwapMode {
+    SWAP_DEFAULT,       // Swap interval is left to driver
+    SWAP_OFF,           // 0, no vsync
+    SWAP_VSYNC,         // 1
+    SWAP_ADAPTIVE       // -1, late frames are not held until next vblank (swap_control_tear)
+};
+
+struct FramePacingConfig {
+    SwapMode swap_mode;
+    double   max_fps;       // Frame limiter, 0 is off
+    bool     on_demand;     // Wait for events, redraw only on input or animation
+    bool     report;        // Print FPS and CPU usage every few seconds
+};
+
+// Default : driver swap interval, no limit, continuous redraw, no report
+FramePacingConfig default_frame_pacing();
+
+// Handles --vsync off|on|adaptive, --fps N, --on-demand, --pacing-report at
+// argv[i], moves i past consumed values. Returns false for other arguments.
+bool parse_frame_pacing_arg(int& i, int argc, char** argv, FramePacingConfig& config);
+
+// Paces main loop : swap interval, frame limiter and on-demand event waiting.
+// Loop calls wait_events() instead of glfwPollEvents() and end_frame() after swap.
+class FramePacer {
+    typedef std::chrono::steady_clock Clock;
+
+    FramePacingConfig config;
+    Clock::time_point next_frame;
+    Clock::time_point report_start;
+    double            report_cpu_start;
+    unsigned int      report_frames;
+    bool              first_frame;
+
+    void report();
+public:
+    // Swap interval is set for current context
+    explicit FramePacer(const FramePacingConfig& config);
+
+    // Polls events, or in on-demand mode blocks until some arrive when
+    // nothing is animating. First frame is always drawn.
+    void wait_events(bool animating);
+
+    // Sleeps and spins until frame limit time, counts frame for report
+    void end_frame();
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// GPU time of named nested scopes, measured with GL_TIMESTAMP queries.
+// Every frame writes its own set of queries, results are read latency frames
+// later when GPU has long finished them, so profiling never stalls pipeline.
+// Frame whose queries are still not available is dropped instead of waited for.
+//
+// Per frame : begin_frame(), GpuScope objects around GL commands, end_frame()
+class GpuProfiler {
+public:
+    static const unsigned int latency = 3;
+    static const unsigned int max_scopes = 64;
+
+    // Scope of collected frame, same name under same parent is summed
+    struct Result {
+        const char*  name;
+        unsigned int depth;     // 0 for top level scopes
+        double       time;      // Milliseconds
+        double       average;   // Exponential moving average over recent frames
+    };
+
+    // Single scope of collected frame in GPU clock (nanoseconds), for timelines
+    struct Span {
+        const char*  name;
+        unsigned int depth;
+        GLuint64     begin;
+        GLuint64     end;
+    };
+private:
+    struct Scope {
+        const char*  name;
+        unsigned int depth;
+    };
+
+    struct Frame {
+        std::vector<Scope>  scopes;
+        GLuint              queries[max_scopes * 2];    // Begin and end of every scope
+        GLuint              last_query;                 // Issued last, available last
+    };
+
+    bool         enabled;
+    Frame        frames[latency];
+    unsigned int frame_index;
+    unsigned int depth;
+    size_t       dropped;
+
+    std::vector<Result>                     results;
+    std::vector<Span>                       spans;
+    std::unordered_map<std::string, double> averages;   // By scope path "frame/draw"
+
+    // Scratch paths reused between frames, collecting does not allocate once warm
+    std::vector<std::string>                paths;          // Ancestors of current scope, index is depth
+    std::vector<std::string>                result_paths;
+
+    void collect(Frame& frame);
+public:
+    // Disabled profiler creates no queries, scopes cost nothing
+    explicit GpuProfiler(bool enable = true);
+    GpuProfiler(const GpuProfiler& rhs) = delete;
+    GpuProfiler& operator= (const GpuProfiler& rhs) = delete;
+    ~GpuProfiler();
+
+    bool is_enabled() const {
+        return enabled;
+    }
+
+    // Reads back frame issued latency frames ago, returns true when it was collected
+    bool begin_frame();
+    void end_frame();
+
+    // Name must outlive profiler (string literal), returns -1 when not recorded
+    int begin_scope(const char* name);
+    void end_scope(int scope);
+
+    // Scope tree of last collected frame, parents precede children
+    const std::vector<Result>& last_frame() const {
+        return results;
+    }
+
+    // Scopes of last collected frame in issue order
+    const std::vector<Span>& last_spans() const {
+        return spans;
+    }
+
+    // Frames skipped because GPU had not finished them in time
+    size_t frames_dropped() const {
+        return dropped;
+    }
+
+    void print(std::ostream& out) const;
+};
+
+// Times GL commands issued during its lifetime
+class GpuScope {
+    GpuProfiler& profiler;
+    int          scope;
+public:
+    GpuScope(GpuProfiler& gpu_profiler, const char* name) :
+        profiler(gpu_profiler), scope(gpu_profiler.begin_scope(name)) {
+    }
+    GpuScope(const GpuScope& rhs) = delete;
+    GpuScope& operator= (const GpuScope& rhs) = delete;
+
+    ~GpuScope() {
+        profiler.end_scope(scope);
+    }
+};
@@ -1,8 +1,12 @@
+#include <frame_pacing.h>
+#include <gpu_profiler.h>
+#include <gl_call_stats.h>
 #define GLAD_GL_IMPLEMENTATION
 #include <glad/gl.h>
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include <cstring>
 
 using namespace std;
 
@@ -55,6 +59,22 @@ GLfloat vertices[] = {
 int main(int argc, char** argv)
 {
     cout << "Application started..." << endl;
+
+    // Frame pacing : --vsync off|on|adaptive, --fps N, --on-demand, --pacing-report
+    // GPU scope timings : --gpu-profile
+    // GL call statistics (debug builds) : --gl-calls
+    FramePacingConfig pacing = default_frame_pacing();
+    bool gpu_profile = false;
+    bool gl_calls = false;
+    for(int i = 1; i < argc; ++i) {
+        if(strcmp(argv[i], "--gpu-profile") == 0)
+            gpu_profile = true;
+        else if(strcmp(argv[i], "--gl-calls") == 0)
+            gl_calls = true;
+        else
+            parse_frame_pacing_arg(i, argc, argv, pacing);
+    }
+
     if (!glfwInit())
         exit(EXIT_FAILURE);
 
@@ -80,6 +100,9 @@ int main(int argc, char** argv)
     // Initialize OpenGL
     gladLoadGL(glfwGetProcAddress);
 
+    if(gl_calls && !install_gl_call_stats())
+        cerr << "Error : GL call statistics are compiled in debug builds only" << endl;
+
     int width, height;
     glfwGetFramebufferSize(window, &width, &height);
     glViewport(0, 0, width, height);
@@ -165,17 +188,36 @@ int main(int argc, char** argv)
         (GLvoid*)0                  // Start data offset
     );
 
-    // Main loop
+    // Main loop, scene is static : on demand it is redrawn only on events
+    FramePacer pacer(pacing);
+    GpuProfiler gpu_profiler(gpu_profile);
+    double profile_report_time = glfwGetTime();
     while (!glfwWindowShouldClose(window))
     {
-        glfwPollEvents();
+        pacer.wait_events(false);
 
         // Render
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-        glDrawArrays(GL_TRIANGLES, 0, 3);
+        gpu_profiler.begin_frame();
+        {
+            GpuScope frame_scope(gpu_profiler, "frame");
+            {
+                GpuScope clear_scope(gpu_profiler, "clear");
+                glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT);
+            }
+            GpuScope draw_scope(gpu_profiler, "triangle");
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+        }
+        gpu_profiler.end_frame();
+        gl_call_stats_end_frame();
 
         glfwSwapBuffers(window);
+        pacer.end_frame();
+
+        if(gpu_profiler.is_enabled() && glfwGetTime() - profile_report_time >= 2.0) {
+            gpu_profiler.print(cout);
+            profile_report_time = glfwGetTime();
+        }
     }
 
     // Shutdown
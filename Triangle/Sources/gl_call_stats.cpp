@@ -0,0 +1,295 @@
+#include <gl_call_stats.h>
+
+#ifdef _DEBUG
+
+#include <glad/gl.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+enum GLFunctionId {
+#define GL_FUNCTION(name) GL_ID_##name,
+#include <gl_functions.inl>
+#undef GL_FUNCTION
+    GL_FUNCTIONS_COUNT
+};
+
+enum CallKind {
+    CALL_PLAIN,
+    CALL_STATE,         // Sets value which can be compared with current one
+    CALL_ROUND_TRIP,    // Returns data, waits for driver (glGet*, glIs*)
+    CALL_INVALIDATE     // Changes bindings behind shadow state (glDelete*, glBindBufferBase, ...)
+};
+
+struct Function {
+    const char*  name;
+    CallKind     kind;
+    bool         timed;
+    const char*  state_group;   // Functions of one group set same state (glEnable, glDisable)
+    unsigned int state_keys;    // Leading arguments selecting state slot (target, capability)
+    bool         per_unit;      // Slot depends on active texture unit
+
+    // Totals of current report window
+    size_t       calls;
+    size_t       redundant;
+    double       time;
+};
+
+Function functions[GL_FUNCTIONS_COUNT];
+
+// Last value of every state slot seen, cleared when bindings may change behind it
+std::unordered_map<uint64_t, uint64_t> shadow;
+uint64_t          active_unit = 0;
+size_t            window_frames = 0;
+Clock::time_point window_start;
+const double      report_interval = 2.0;
+bool              installed = false;
+
+struct StateFunction {
+    const char*  name;
+    const char*  group;
+    unsigned int keys;
+    bool         per_unit;
+};
+
+const StateFunction state_functions[] = {
+    { "glUseProgram",        "program",        0, false },
+    { "glBindVertexArray",   "vertex array",   0, false },
+    { "glBindBuffer",        "buffer",         1, false },
+    { "glBindTexture",       "texture",        1, true  },
+    { "glActiveTexture",     "active texture", 0, false },
+    { "glBindSampler",       "sampler",        1, false },
+    { "glBindFramebuffer",   "framebuffer",    1, false },
+    { "glBindRenderbuffer",  "renderbuffer",   1, false },
+    { "glEnable",            "capability",     1, false },
+    { "glDisable",           "capability",     1, false },
+    { "glViewport",          "viewport",       0, false },
+    { "glScissor",           "scissor",        0, false },
+    { "glClearColor",        "clear color",    0, false },
+    { "glClearDepth",        "clear depth",    0, false },
+    { "glBlendFunc",         "blend func",     0, false },
+    { "glBlendEquation",     "blend equation", 0, false },
+    { "glDepthFunc",         "depth func",     0, false },
+    { "glDepthMask",         "depth mask",     0, false },
+    { "glColorMask",         "color mask",     0, false },
+    { "glCullFace",          "cull face",      0, false },
+    { "glFrontFace",         "front face",     0, false },
+    { "glPolygonMode",       "polygon mode",   1, false },
+    { "glPixelStorei",       "pixel store",    1, false },
+    { "glLineWidth",         "line width",     0, false }
+};
+
+// CPU cost depends on data size or may block on GPU
+const char* const timed_functions[] = {
+    "glBufferData", "glBufferSubData", "glMapBuffer", "glMapBufferRange", "glUnmapBuffer",
+    "glTexImage2D", "glTexImage3D", "glTexSubImage2D", "glTexSubImage3D",
+    "glCompressedTexImage2D", "glCompressedTexSubImage2D", "glGenerateMipmap",
+    "glGetTexImage", "glReadPixels", "glCompileShader", "glLinkProgram",
+    "glFinish", "glFlush", "glClientWaitSync", "glGetQueryObjectui64v", "glClear"
+};
+
+bool starts_with(const char* name, const char* prefix) {
+    return strncmp(name, prefix, strlen(prefix)) == 0;
+}
+
+void classify(Function& function, const char* name) {
+    function = Function();
+    function.name = name;
+    function.kind = CALL_PLAIN;
+
+    for(const StateFunction& state : state_functions) {
+        if(strcmp(name, state.name) == 0) {
+            function.kind = CALL_STATE;
+            function.state_group = state.group;
+            function.state_keys = state.keys;
+            function.per_unit = state.per_unit;
+        }
+    }
+    if(function.kind == CALL_PLAIN) {
+        if(starts_with(name, "glGet") || starts_with(name, "glIs"))
+            function.kind = CALL_ROUND_TRIP;
+        else if(starts_with(name, "glDelete") || starts_with(name, "glBind"))
+            function.kind = CALL_INVALIDATE;
+    }
+
+    for(const char* timed : timed_functions)
+        if(strcmp(name, timed) == 0)
+            function.timed = true;
+    if(starts_with(name, "glDraw") || starts_with(name, "glMultiDraw"))
+        function.timed = true;
+}
+
+template<typename T>
+uint64_t to_bits(T value) {
+    if constexpr(std::is_pointer<T>::value) {
+        return (uint64_t)(uintptr_t)value;
+    } else if constexpr(std::is_floating_point<T>::value) {
+        uint64_t bits = 0;
+        memcpy(&bits, &value, sizeof(value));
+        return bits;
+    } else {
+        return (uint64_t)value;
+    }
+}
+
+uint64_t combine(uint64_t hash, uint64_t value) {
+    return (hash ^ value) * 0x100000001b3ull;
+}
+
+// Returns true when call sets state slot to value it already has
+bool is_redundant(unsigned int id, const uint64_t* args, unsigned int count) {
+    const Function& function = functions[id];
+    uint64_t slot = combine(0xcbf29ce484222325ull, (uint64_t)(uintptr_t)function.state_group);
+    if(function.per_unit)
+        slot = combine(slot, active_unit);
+    uint64_t value = combine(0xcbf29ce484222325ull, id);
+    for(unsigned int i = 0; i < count; ++i) {
+        if(i < function.state_keys)
+            slot = combine(slot, args[i]);
+        else
+            value = combine(value, args[i]);
+    }
+
+    if(id == GL_ID_glActiveTexture)
+        active_unit = args[0];
+
+    auto found = shadow.find(slot);
+    if(found != shadow.end() && found->second == value)
+        return true;
+    shadow[slot] = value;
+
+    // Element buffer binding belongs to vertex array, which has just changed
+    if(id == GL_ID_glBindVertexArray) {
+        uint64_t element_slot = combine(combine(0xcbf29ce484222325ull,
+            (uint64_t)(uintptr_t)functions[GL_ID_glBindBuffer].state_group), GL_ELEMENT_ARRAY_BUFFER);
+        shadow.erase(element_slot);
+    }
+    return false;
+}
+
+template<unsigned int Id, typename F>
+struct Hook;
+
+template<unsigned int Id, typename R, typename... Args>
+struct Hook<Id, R (GLAD_API_PTR *)(Args...)> {
+    static R (GLAD_API_PTR *original)(Args...);
+
+    static R GLAD_API_PTR call(Args... args) {
+        Function& function = functions[Id];
+        ++function.calls;
+        if(function.kind == CALL_STATE) {
+            const uint64_t values[] = { 0, to_bits(args)... };
+            if(is_redundant(Id, values + 1, sizeof...(Args)))
+                ++function.redundant;
+        } else if(function.kind == CALL_INVALIDATE) {
+            shadow.clear();
+        }
+
+        if(!function.timed)
+            return original(args...);
+
+        // Timer stops when call returns, for void and value results alike
+        struct Timer {
+            Function&         function;
+            Clock::time_point start;
+            ~Timer() {
+                function.time += std::chrono::duration<double>(Clock::now() - start).count();
+            }
+        } timer = { function, Clock::now() };
+        return original(args...);
+    }
+};
+
+template<unsigned int Id, typename R, typename... Args>
+R (GLAD_API_PTR *Hook<Id, R (GLAD_API_PTR *)(Args...)>::original)(Args...) = NULL;
+
+template<unsigned int Id, typename F>
+void install(F& pointer, const char* name) {
+    classify(functions[Id], name);
+    if(!pointer)
+        return;
+    Hook<Id, F>::original = pointer;
+    pointer = &Hook<Id, F>::call;
+}
+
+void print_report() {
+    const double frames = (double)window_frames;
+    size_t calls = 0, redundant = 0, round_trips = 0;
+    std::vector<const Function*> called;
+    for(const Function& function : functions) {
+        if(!function.calls)
+            continue;
+        called.push_back(&function);
+        calls += function.calls;
+        redundant += function.redundant;
+        if(function.kind == CALL_ROUND_TRIP)
+            round_trips += function.calls;
+    }
+    std::sort(called.begin(), called.end(), [](const Function* lhs, const Function* rhs) {
+        return lhs->calls > rhs->calls;
+    });
+
+    const std::ios::fmtflags flags = std::cout.flags();
+    const std::streamsize precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(1)
+              << "GL calls per frame : " << calls / frames << " (" << called.size() << " entry points)"
+              << ", redundant state : " << redundant / frames
+              << ", round trips : " << round_trips / frames << std::endl;
+    for(const Function* function : called) {
+        std::cout << "  " << std::left << std::setw(28) << function->name << std::right
+                  << std::setw(8) << function->calls / frames;
+        if(function->timed)
+            std::cout << ", " << std::setprecision(3) << function->time * 1e6 / function->calls
+                      << " us/call, " << function->time * 1e3 / frames << " ms/frame" << std::setprecision(1);
+        if(function->redundant)
+            std::cout << ", redundant " << function->redundant / frames;
+        if(function->kind == CALL_ROUND_TRIP)
+            std::cout << ", round trip";
+        std::cout << std::endl;
+    }
+    const Function& get_error = functions[GL_ID_glGetError];
+    if(get_error.calls)
+        std::cout << "  glGetError waits for driver on every call, use KHR_debug output instead" << std::endl;
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
+
+}
+
+bool install_gl_call_stats() {
+#define GL_FUNCTION(name) install<GL_ID_##name>(glad_##name, #name);
+#include <gl_functions.inl>
+#undef GL_FUNCTION
+    window_start = Clock::now();
+    installed = true;
+    return true;
+}
+
+void gl_call_stats_end_frame() {
+    if(!installed)
+        return;
+    ++window_frames;
+    if(std::chrono::duration<double>(Clock::now() - window_start).count() < report_interval)
+        return;
+
+    print_report();
+    for(Function& function : functions) {
+        function.calls = 0;
+        function.redundant = 0;
+        function.time = 0.0;
+    }
+    window_frames = 0;
+    window_start = Clock::now();
+}
+
+#endif